@@ -0,0 +1,185 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+Arena* Arena::sCurrent = nullptr;
+
+static const size_t sAlignment = alignof(std::max_align_t);
+
+static const size_t sMaxChunkSize = 4 * 1024 * 1024;
+
+// Chunks of all live arenas ordered by address, so a free looks up its chunk
+// instead of asking every arena in turn
+
+struct ChunkRange
+{
+    const char* begin;
+    const char* end;
+};
+
+static std::vector<ChunkRange>& chunk_index()
+{
+    static std::vector<ChunkRange> index;
+    return index;
+}
+
+static bool operator<(const char* address, const ChunkRange& range)
+{
+    return address < range.begin;
+}
+
+static bool operator<(const ChunkRange& range, const char* address)
+{
+    return range.begin < address;
+}
+
+Arena::Arena(size_t chunkSize) :
+    mPosition(nullptr),
+    mEnd(nullptr),
+    mChunkSize(chunkSize),
+    mBytesAllocated(0)
+{
+
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void* Arena::allocate(size_t size)
+{
+    size = (size + sAlignment - 1) & ~(sAlignment - 1);
+
+    if ((size_t)(mEnd - mPosition) < size)
+    {
+        //// Start a new chunk, each one twice as large as the previous ------
+
+        size_t chunkSize = mChunkSize;
+
+        if (chunkSize < size)
+        {
+            chunkSize = size;
+        }
+
+        char* data = static_cast<char*>(malloc(chunkSize));
+
+        if (data == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        Chunk chunk = { data, chunkSize };
+        mChunks.push_back(chunk);
+
+        std::vector<ChunkRange>& index = chunk_index();
+        ChunkRange range = { data, data + chunkSize };
+        index.insert(std::upper_bound(index.begin(), index.end(), range.begin), range);
+
+        mPosition = data;
+        mEnd      = data + chunkSize;
+
+        if (mChunkSize < sMaxChunkSize)
+        {
+            mChunkSize *= 2;
+        }
+    }
+
+    void* result = mPosition;
+
+    mPosition       += size;
+    mBytesAllocated += size;
+
+    return result;
+}
+
+bool Arena::owns(const void* pointer) const
+{
+    const char* address = static_cast<const char*>(pointer);
+
+    for (const Chunk& chunk : mChunks)
+    {
+        if (address >= chunk.data && address < chunk.data + chunk.size)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Arena::release()
+{
+    std::vector<ChunkRange>& index = chunk_index();
+
+    for (const Chunk& chunk : mChunks)
+    {
+        const char* begin = chunk.data;
+        index.erase(std::lower_bound(index.begin(), index.end(), begin));
+
+        free(chunk.data);
+    }
+
+    mChunks.clear();
+
+    mPosition       = nullptr;
+    mEnd            = nullptr;
+    mBytesAllocated = 0;
+}
+
+size_t Arena::chunks() const
+{
+    return mChunks.size();
+}
+
+size_t Arena::bytesAllocated() const
+{
+    return mBytesAllocated;
+}
+
+Arena* Arena::current()
+{
+    return sCurrent;
+}
+
+bool Arena::isArenaMemory(const void* pointer)
+{
+    const char* address = static_cast<const char*>(pointer);
+
+    // Most frees hit the chunk the current arena is carving from
+
+    if (sCurrent != nullptr && not sCurrent->mChunks.empty())
+    {
+        const Chunk& chunk = sCurrent->mChunks.back();
+
+        if (address >= chunk.data && address < chunk.data + chunk.size)
+        {
+            return true;
+        }
+    }
+
+    const std::vector<ChunkRange>& index = chunk_index();
+
+    if (index.empty())
+    {
+        return false;
+    }
+
+    std::vector<ChunkRange>::const_iterator it = std::upper_bound(index.begin(), index.end(), address);
+
+    return (it != index.begin()) && (address < (it - 1)->end);
+}
+
+//// Scope =====================================================================
+
+ArenaScope::ArenaScope(Arena& arena) :
+    mPrevious(Arena::sCurrent)
+{
+    Arena::sCurrent = &arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+    Arena::sCurrent = mPrevious;
+}
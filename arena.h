@@ -0,0 +1,134 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+class Arena
+{
+public:
+    Arena(size_t chunkSize = 64 * 1024);
+    ~Arena();
+
+    void* allocate(size_t size);
+    bool  owns(const void* pointer) const;
+
+    void  release();
+
+    size_t chunks() const;
+    size_t bytesAllocated() const;
+
+    static Arena* current();
+
+    // Whether the memory came from any live arena, current or not. Looks in
+    // the chunk the current arena carves from first, then in an address
+    // ordered index of all chunks
+
+    static bool isArenaMemory(const void* pointer);
+
+private:
+
+    struct Chunk
+    {
+        char*  data;
+        size_t size;
+    };
+
+    std::vector<Chunk> mChunks;
+
+    char*  mPosition;
+    char*  mEnd;
+    size_t mChunkSize;
+    size_t mBytesAllocated;
+
+    friend class ArenaScope;
+
+    static Arena* sCurrent;
+
+    Arena(const Arena& other);
+    Arena& operator=(const Arena& other);
+};
+
+//// Scope =====================================================================
+
+// Makes an arena current for ArenaAllocator until the scope ends.
+// Everything allocated inside must be destroyed before the arena is.
+
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena& arena);
+    ~ArenaScope();
+
+private:
+
+    Arena* mPrevious;
+
+    ArenaScope(const ArenaScope& other);
+    ArenaScope& operator=(const ArenaScope& other);
+};
+
+//// Allocator =================================================================
+
+// Stateless allocator: takes memory from the current arena, or from the heap
+// when no arena is current. Freeing memory of any live arena is a no-op,
+// whichever arena is current at the time.
+//
+// Only the option sets of file options (internedset) and the blocks behind
+// CowPtr use it; strings, string lists, build steps and the file path list
+// keep the default allocator.
+
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    ArenaAllocator()
+    {
+
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&)
+    {
+
+    }
+
+    T* allocate(size_t count)
+    {
+        Arena* arena = Arena::current();
+
+        if (arena != nullptr)
+        {
+            return static_cast<T*>(arena->allocate(count * sizeof(T)));
+        }
+
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t)
+    {
+        if (Arena::isArenaMemory(pointer))
+        {
+            return;
+        }
+
+        ::operator delete(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>&) const
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>&) const
+    {
+        return false;
+    }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,330 @@
+#include "buildgraph.h"
+
+#include <algorithm>
+#include <map>
+
+#include "utils.h"
+
+BuildGraph::BuildGraph() : mTotalWork(0.0), mMaxParallelism(0), mTimed(false)
+{
+
+}
+
+void BuildGraph::build(const ProjectSettings& settings, const BuildTimes& buildTimes, const std::string& sourceDir)
+{
+    mNodes.clear();
+    mCriticalPath.clear();
+    mTimed = not buildTimes.empty();
+
+    uint32_t tools = settings.toolFlags();
+
+    bool archive = (settings.projectType() == ProjectSettings::Type::LIBRARY &&
+                    (tools & ProjectSettings::TOOL_ARCHIVER));
+
+    //// Sources, memory maps and archives are shared by all configs ===========
+
+    std::map<std::string, size_t> fileNodes;
+
+    for (const std::string& file : settings.files())
+    {
+        fileNodes[file] = addNode(file, std::string(), SOURCE);
+    }
+
+    //// Compile durations, estimated from source sizes without history ======
+
+    std::map<std::string, unsigned long> sizes;
+
+    for (const std::string& configName : settings.configs())
+    {
+        for (const std::string& source : settings.c_sources())
+        {
+            std::string sourcePath = sourceDir.empty() ? source : sourceDir + "/" + source;
+            sizes[configName + "/" + settings.filePath(settings.fileId(source)).objectName()] = file_size(sourcePath);
+        }
+    }
+
+    std::map<std::string, double> durations = buildTimes.estimate(sizes);
+
+    //// Configurations ========================================================
+
+    for (const std::string& configName : settings.configs())
+    {
+        const ConfigSettings& config = settings.c_configSettings(configName);
+
+        //// Prebuild waits for every source, objects are ordered after it -----
+
+        size_t preBuild = addNode(configName + "/pre_build", configName, PRE_BUILD,
+                                  stepsDuration(buildTimes, configName + "/pre_build", config.c_preBuildSteps().size()));
+
+        for (const auto& file : fileNodes)
+        {
+            mNodes[preBuild].dependencies.push_back(file.second);
+        }
+
+        //// Objects -----------------------------------------------------------
+
+        std::vector<size_t> objects;
+
+        if (tools & ProjectSettings::TOOL_COMPILER)
+        {
+            for (const std::string& source : settings.c_sources())
+            {
+                std::string target = configName + "/" + settings.filePath(settings.fileId(source)).objectName();
+
+                size_t object = addNode(target, configName, OBJECT, durations.at(target));
+
+                mNodes[object].dependencies.push_back(fileNodes.at(source));
+                mNodes[object].dependencies.push_back(preBuild);
+
+                objects.push_back(object);
+            }
+        }
+
+        //// Link or archive ---------------------------------------------------
+
+        size_t output = preBuild;
+
+        if (tools & ProjectSettings::TOOL_LINKER)
+        {
+            size_t link = addNode(configName + "/link", configName, LINK,
+                                  (double)buildTimes.duration(configName + "/link"));
+
+            mNodes[link].dependencies = objects;
+            mNodes[link].dependencies.push_back(preBuild);
+
+            for (const std::string& file : settings.c_commands())
+            {
+                mNodes[link].dependencies.push_back(fileNodes.at(file));
+            }
+
+            for (const std::string& file : settings.c_libraries())
+            {
+                mNodes[link].dependencies.push_back(fileNodes.at(file));
+            }
+
+            output = link;
+        }
+
+        if (archive)
+        {
+            size_t library = addNode(configName + "/archive", configName, ARCHIVE,
+                                     (double)buildTimes.duration(configName + "/archive"));
+
+            mNodes[library].dependencies = objects;
+            mNodes[library].dependencies.push_back(preBuild);
+
+            output = library;
+        }
+
+        //// Postbuild ---------------------------------------------------------
+
+        size_t postBuild = addNode(configName + "/post_build", configName, POST_BUILD,
+                                   stepsDuration(buildTimes, configName + "/post_build", config.c_postBuildSteps().size()));
+
+        mNodes[postBuild].dependencies.push_back(output);
+    }
+
+    analyze();
+}
+
+const std::vector<BuildGraph::Node>& BuildGraph::nodes() const
+{
+    return mNodes;
+}
+
+const std::vector<size_t>& BuildGraph::criticalPath() const
+{
+    return mCriticalPath;
+}
+
+double BuildGraph::totalWork() const
+{
+    return mTotalWork;
+}
+
+double BuildGraph::criticalPathLength() const
+{
+    if (mCriticalPath.empty())
+    {
+        return 0.0;
+    }
+
+    return mNodes.at(mCriticalPath.back()).finish;
+}
+
+size_t BuildGraph::maxParallelism() const
+{
+    return mMaxParallelism;
+}
+
+std::string BuildGraph::units() const
+{
+    return mTimed ? "ms" : "bytes";
+}
+
+std::string BuildGraph::nodeTypeString(int type)
+{
+    switch (type)
+    {
+    case SOURCE:
+        return "source";
+
+    case PRE_BUILD:
+        return "pre_build";
+
+    case OBJECT:
+        return "compile";
+
+    case LINK:
+        return "link";
+
+    case ARCHIVE:
+        return "archive";
+
+    case POST_BUILD:
+        return "post_build";
+
+    case NODE_TYPE_COUNT:
+        return std::string();
+    }
+
+    return std::string();
+}
+
+size_t BuildGraph::addNode(const std::string& name, const std::string& config, NodeType type, double weight)
+{
+    Node node;
+
+    node.name     = name;
+    node.config   = config;
+    node.type     = type;
+    node.weight   = weight;
+    node.start    = 0.0;
+    node.finish   = 0.0;
+    node.critical = false;
+    node.serial   = false;
+
+    mNodes.push_back(node);
+
+    return mNodes.size() - 1;
+}
+
+double BuildGraph::stepsDuration(const BuildTimes& buildTimes, const std::string& target, size_t steps)
+{
+    double duration = 0.0;
+
+    for (size_t step = 1; step <= steps; ++step)
+    {
+        duration += (double)buildTimes.duration(string_format("%s.%u", target.c_str(), (unsigned int)step));
+    }
+
+    return duration;
+}
+
+void BuildGraph::analyze()
+{
+    mTotalWork      = 0.0;
+    mMaxParallelism = 0;
+
+    //// Earliest schedule with unlimited jobs, nodes are in dependency order ==
+
+    size_t last = 0;
+
+    for (size_t i = 0; i < mNodes.size(); ++i)
+    {
+        Node& node = mNodes[i];
+
+        node.start = 0.0;
+
+        for (size_t dependency : node.dependencies)
+        {
+            node.start = std::max(node.start, mNodes.at(dependency).finish);
+        }
+
+        node.finish = node.start + node.weight;
+
+        mTotalWork += node.weight;
+
+        if (node.finish >= mNodes.at(last).finish)
+        {
+            last = i;
+        }
+    }
+
+    if (mNodes.empty())
+    {
+        return;
+    }
+
+    //// Critical path =========================================================
+
+    for (size_t current = last; ; )
+    {
+        mNodes[current].critical = true;
+        mCriticalPath.push_back(current);
+
+        const Node& node = mNodes.at(current);
+
+        if (node.dependencies.empty())
+        {
+            break;
+        }
+
+        size_t previous = node.dependencies.front();
+
+        for (size_t dependency : node.dependencies)
+        {
+            if (mNodes.at(dependency).finish > mNodes.at(previous).finish)
+            {
+                previous = dependency;
+            }
+        }
+
+        current = previous;
+    }
+
+    std::reverse(mCriticalPath.begin(), mCriticalPath.end());
+
+    //// Peak concurrency and steps running alone ==============================
+
+    std::vector<std::pair<double, int> > events;
+
+    for (const Node& node : mNodes)
+    {
+        if (node.weight > 0.0)
+        {
+            events.push_back(std::make_pair(node.start, 1));
+            events.push_back(std::make_pair(node.finish, -1));
+        }
+    }
+
+    std::sort(events.begin(), events.end());
+
+    int running = 0;
+
+    for (const auto& event : events)
+    {
+        running += event.second;
+        mMaxParallelism = std::max(mMaxParallelism, (size_t)std::max(running, 0));
+    }
+
+    for (Node& node : mNodes)
+    {
+        if (not node.critical || node.weight <= 0.0)
+        {
+            continue;
+        }
+
+        node.serial = true;
+
+        for (const Node& other : mNodes)
+        {
+            if (&other != &node && other.weight > 0.0 &&
+                other.start < node.finish && other.finish > node.start)
+            {
+                node.serial = false;
+                break;
+            }
+        }
+    }
+}
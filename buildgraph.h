@@ -0,0 +1,71 @@
+#ifndef BUILDGRAPH_H
+#define BUILDGRAPH_H
+
+#include <string>
+#include <vector>
+
+#include "projectsettings.h"
+#include "buildtimes.h"
+
+class BuildGraph
+{
+public:
+
+    enum NodeType
+    {
+        SOURCE,
+        PRE_BUILD,
+        OBJECT,
+        LINK,
+        ARCHIVE,
+        POST_BUILD,
+
+        NODE_TYPE_COUNT
+    };
+
+    struct Node
+    {
+        std::string         name;
+        std::string         config;
+        NodeType            type;
+        double              weight;
+        std::vector<size_t> dependencies;
+
+        double              start;
+        double              finish;
+        bool                critical;
+        bool                serial;
+    };
+
+public:
+    BuildGraph();
+
+    void build(const ProjectSettings& settings, const BuildTimes& buildTimes, const std::string& sourceDir = std::string());
+
+    const std::vector<Node>& nodes() const;
+    const std::vector<size_t>& criticalPath() const;
+
+    double totalWork() const;
+    double criticalPathLength() const;
+    size_t maxParallelism() const;
+
+    std::string units() const;
+
+    static std::string nodeTypeString(int type);
+
+private:
+
+    std::vector<Node>   mNodes;
+    std::vector<size_t> mCriticalPath;
+    double              mTotalWork;
+    size_t              mMaxParallelism;
+    bool                mTimed;
+
+    size_t addNode(const std::string& name, const std::string& config, NodeType type, double weight = 0.0);
+
+    static double stepsDuration(const BuildTimes& buildTimes, const std::string& target, size_t steps);
+
+    void analyze();
+};
+
+#endif // BUILDGRAPH_H
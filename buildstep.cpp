@@ -16,7 +16,13 @@ BuildStep::BuildStep() : mCondition(IF_ANY_FILE_BUILDS)
 }
 
 BuildStep::BuildStep(const BuildStep& other) :
-    mCommand(other.mCommand), mCondition(other.mCondition)
+    mCommand(other.mCommand), mCondition(other.mCondition), mTemplate(other.mTemplate)
+{
+
+}
+
+BuildStep::BuildStep(BuildStep&& other) noexcept :
+    mCommand(std::move(other.mCommand)), mCondition(other.mCondition), mTemplate(std::move(other.mTemplate))
 {
 
 }
@@ -31,6 +37,16 @@ BuildStep& BuildStep::operator=(const BuildStep& other)
 {
     this->mCommand = other.mCommand;
     this->mCondition = other.mCondition;
+    this->mTemplate = other.mTemplate;
+
+    return *this;
+}
+
+BuildStep& BuildStep::operator=(BuildStep&& other) noexcept
+{
+    this->mCommand = std::move(other.mCommand);
+    this->mCondition = other.mCondition;
+    this->mTemplate = std::move(other.mTemplate);
 
     return *this;
 }
@@ -56,6 +72,16 @@ int BuildStep::condition() const
     return mCondition;
 }
 
+const VariableString& BuildStep::commandTemplate() const
+{
+    if (not mTemplate)
+    {
+        mTemplate = std::make_shared<const VariableString>(mCommand);
+    }
+
+    return *mTemplate;
+}
+
 BuildStep BuildStep::fromString(std::string command)
 {
     BuildCondition condition = IF_ANY_FILE_BUILDS;
@@ -2,6 +2,9 @@
 #define BUILDSTEP_H
 
 #include <string>
+#include <memory>
+
+#include "variablestring.h"
 
 class BuildStep
 {
@@ -18,9 +21,11 @@ public:
 public:
     BuildStep();
     BuildStep(const BuildStep& other);
+    BuildStep(BuildStep&& other) noexcept;
     BuildStep(const std::string& command, BuildCondition condition);
 
     BuildStep& operator=(const BuildStep& other);
+    BuildStep& operator=(BuildStep&& other) noexcept;
 
     operator std::pair<std::string, int>() const;
     bool operator==(const BuildStep& other) const;
@@ -29,6 +34,10 @@ public:
     std::string command() const;
     int         condition() const;
 
+    // Command split into text and %VAR% references on first use
+
+    const VariableString& commandTemplate() const;
+
     static BuildStep fromString(std::string command);
     std::string toString() const;
 
@@ -39,6 +48,8 @@ private:
     std::string    mCommand;
     BuildCondition mCondition;
 
+    mutable std::shared_ptr<const VariableString> mTemplate;
+
 };
 
 #endif // BUILDSTEP_H
@@ -1,25 +1,60 @@
 #include "buildsteplist.h"
 
-BuildStepList::BuildStepList()
+#include "modelversion.h"
+#include "utils.h"
+
+BuildStepList::BuildStepList() : mHash(0), mHashValid(false)
 {
 
 }
 
 BuildStepList::BuildStepList(const BuildStepList& other) :
-    mBuildStepList(other.mBuildStepList)
+    mBuildStepList(other.mBuildStepList),
+    mHash(other.mHash),
+    mHashValid(other.mHashValid)
 {
 
 }
 
+BuildStepList::BuildStepList(BuildStepList&& other) noexcept :
+    mBuildStepList(std::move(other.mBuildStepList)),
+    mHash(other.mHash),
+    mHashValid(other.mHashValid)
+{
+    other.mHashValid = false;
+    ModelVersion::bump();
+}
+
 BuildStepList& BuildStepList::operator=(const BuildStepList& other)
 {
     this->mBuildStepList = other.mBuildStepList;
+    this->mHash = other.mHash;
+    this->mHashValid = other.mHashValid;
+
+    ModelVersion::bump();
+
+    return *this;
+}
+
+BuildStepList& BuildStepList::operator=(BuildStepList&& other) noexcept
+{
+    this->mBuildStepList = std::move(other.mBuildStepList);
+    this->mHash = other.mHash;
+    this->mHashValid = other.mHashValid;
+
+    other.mHashValid = false;
+    ModelVersion::bump();
 
     return *this;
 }
 
 bool BuildStepList::operator==(const BuildStepList& other) const
 {
+    if (this->hash() != other.hash())
+    {
+        return false;
+    }
+
     return (this->mBuildStepList == other.mBuildStepList);
 }
 
@@ -28,33 +63,68 @@ bool BuildStepList::operator!=(const BuildStepList& other) const
     return !(*this == other);
 }
 
-BuildStepList::operator std::list<BuildStep>() const
+BuildStepList::operator std::vector<BuildStep>() const
+{
+    return mBuildStepList;
+}
+
+std::vector<BuildStep> BuildStepList::get() const
 {
     return mBuildStepList;
 }
 
-std::list<BuildStep> BuildStepList::get() const
+const std::vector<BuildStep>& BuildStepList::c_get() const
 {
     return mBuildStepList;
 }
 
 void BuildStepList::add(const BuildStep& buildStep)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mBuildStepList.push_back(buildStep);
 }
 
 void BuildStepList::add(const std::string& buildStep)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mBuildStepList.push_back(BuildStep::fromString(buildStep));
 }
 
 void BuildStepList::add(const std::string& action, int condition)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mBuildStepList.push_back(BuildStep(action,
                                        BuildStep::BuildCondition(condition)));
 }
 
 void BuildStepList::clear()
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mBuildStepList.clear();
 }
+
+uint64_t BuildStepList::hash() const
+{
+    if (not mHashValid)
+    {
+        mHash = hash_combine(0, mBuildStepList.size());
+
+        for (const BuildStep& step : mBuildStepList)
+        {
+            mHash = hash_combine(mHash, hash_string(step.command()));
+            mHash = hash_combine(mHash, (uint64_t)step.condition());
+        }
+
+        mHashValid = true;
+    }
+
+    return mHash;
+}
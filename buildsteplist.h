@@ -1,7 +1,8 @@
 #ifndef BUILDSTEPLIST_H
 #define BUILDSTEPLIST_H
 
-#include <list>
+#include <stdint.h>
+#include <vector>
 
 #include "buildstep.h"
 
@@ -10,13 +11,16 @@ class BuildStepList
 public:
     BuildStepList();
     BuildStepList(const BuildStepList& other);
+    BuildStepList(BuildStepList&& other) noexcept;
 
     BuildStepList& operator=(const BuildStepList& other);
+    BuildStepList& operator=(BuildStepList&& other) noexcept;
     bool operator==(const BuildStepList& other) const;
     bool operator!=(const BuildStepList& other) const;
 
-    operator std::list<BuildStep>() const;
-    std::list<BuildStep> get() const;
+    operator std::vector<BuildStep>() const;
+    std::vector<BuildStep> get() const;
+    const std::vector<BuildStep>& c_get() const;
 
     void add(const BuildStep& buildStep);
     void add(const std::string& buildStep);
@@ -24,9 +28,14 @@ public:
 
     void clear();
 
+    uint64_t hash() const;
+
 private:
 
-    std::list<BuildStep> mBuildStepList;
+    std::vector<BuildStep> mBuildStepList;
+
+    mutable uint64_t       mHash;
+    mutable bool           mHashValid;
 };
 
 #endif // BUILDSTEPLIST_H
@@ -0,0 +1,161 @@
+#include "buildtimes.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+
+#include "utils.h"
+
+BuildTimes::BuildTimes() : mRecords(0)
+{
+
+}
+
+bool BuildTimes::load(const std::string& path)
+{
+    mDurations.clear();
+    mRecords = 0;
+    mLastError.clear();
+
+    std::ifstream file(path.c_str());
+
+    if (not file.is_open())
+    {
+        mLastError = string_format("Failed to open build times '%s': '%s'", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    //// Each line is "<milliseconds> <target>", later records win ============
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        char* end = nullptr;
+        unsigned long duration = strtoul(line.c_str(), &end, 10);
+
+        if (end == line.c_str() || *end != ' ' || end[1] == '\0')
+        {
+            continue;
+        }
+
+        record(std::string(end + 1), duration);
+    }
+
+    return true;
+}
+
+bool BuildTimes::save(const std::string& path) const
+{
+    mLastError.clear();
+
+    std::string tempPath = path + ".tmp";
+
+    {
+        std::ofstream file(tempPath.c_str());
+
+        if (not file.is_open())
+        {
+            mLastError = string_format("Failed to open build times '%s': '%s'", tempPath.c_str(), strerror(errno));
+            return false;
+        }
+
+        for (const auto& duration : mDurations)
+        {
+            file << duration.second << ' ' << duration.first << std::endl;
+        }
+    }
+
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+
+    if (rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        mLastError = string_format("Failed to replace build times '%s': '%s'", path.c_str(), strerror(errno));
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+std::string BuildTimes::lastError() const
+{
+    return mLastError;
+}
+
+bool BuildTimes::empty() const
+{
+    return mDurations.empty();
+}
+
+bool BuildTimes::compacted() const
+{
+    return mRecords == mDurations.size();
+}
+
+bool BuildTimes::contains(const std::string& target) const
+{
+    return mDurations.find(target) != mDurations.end();
+}
+
+unsigned long BuildTimes::duration(const std::string& target) const
+{
+    auto it = mDurations.find(target);
+
+    if (it == mDurations.end())
+    {
+        return 0;
+    }
+
+    return it->second;
+}
+
+void BuildTimes::record(const std::string& target, unsigned long duration)
+{
+    mDurations[target] = duration;
+    ++mRecords;
+}
+
+std::map<std::string, double> BuildTimes::estimate(const std::map<std::string, unsigned long>& sizes) const
+{
+    unsigned long long knownSize     = 0;
+    unsigned long long knownDuration = 0;
+
+    for (const auto& size : sizes)
+    {
+        if (contains(size.first))
+        {
+            knownSize     += size.second;
+            knownDuration += duration(size.first);
+        }
+    }
+
+    //// Targets without history are estimated from their source size ---------
+
+    double durationPerByte = 1.0;
+
+    if (knownSize > 0 && knownDuration > 0)
+    {
+        durationPerByte = (double)knownDuration / (double)knownSize;
+    }
+
+    std::map<std::string, double> result;
+
+    for (const auto& size : sizes)
+    {
+        if (contains(size.first))
+        {
+            result[size.first] = (double)duration(size.first);
+        }
+        else
+        {
+            result[size.first] = size.second * durationPerByte;
+        }
+    }
+
+    return result;
+}
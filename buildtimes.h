@@ -0,0 +1,35 @@
+#ifndef BUILDTIMES_H
+#define BUILDTIMES_H
+
+#include <map>
+#include <string>
+
+class BuildTimes
+{
+public:
+    BuildTimes();
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    std::string lastError() const;
+
+    bool empty() const;
+    bool compacted() const;
+
+    bool          contains(const std::string& target) const;
+    unsigned long duration(const std::string& target) const;
+
+    void record(const std::string& target, unsigned long duration);
+
+    std::map<std::string, double> estimate(const std::map<std::string, unsigned long>& sizes) const;
+
+private:
+
+    std::map<std::string, unsigned long> mDurations;
+    size_t                               mRecords;
+
+    mutable std::string                  mLastError;
+};
+
+#endif // BUILDTIMES_H
@@ -0,0 +1,172 @@
+#include "buildtrace.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+
+#include "utils.h"
+
+static bool earlierStart(const BuildTrace::Record& a, const BuildTrace::Record& b)
+{
+    return a.start < b.start;
+}
+
+static bool longerRecord(const BuildTrace::Record& a, const BuildTrace::Record& b)
+{
+    return (a.end - a.start) > (b.end - b.start);
+}
+
+BuildTrace::BuildTrace()
+{
+
+}
+
+bool BuildTrace::load(const std::string& path)
+{
+    mLastError.clear();
+
+    std::ifstream file(path.c_str());
+
+    if (not file.is_open())
+    {
+        mLastError = string_format("Failed to open trace log '%s': '%s'", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    //// Each line is "<start ns> <end ns> <pid> <kind> <config> <target>" =====
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        Record record;
+        int    chars = 0;
+
+        char kind[64];
+        char config[256];
+
+        if (sscanf(line.c_str(), "%llu %llu %lu %63s %255s %n",
+                   &record.start, &record.end, &record.pid, kind, config, &chars) != 5)
+        {
+            continue;
+        }
+
+        if (chars <= 0 || line.c_str()[chars] == '\0' || record.end < record.start)
+        {
+            continue;
+        }
+
+        record.kind   = kind;
+        record.config = config;
+        record.target = line.substr((size_t)chars);
+
+        mRecords.push_back(record);
+    }
+
+    std::stable_sort(mRecords.begin(), mRecords.end(), earlierStart);
+
+    return true;
+}
+
+std::string BuildTrace::lastError() const
+{
+    return mLastError;
+}
+
+const std::vector<BuildTrace::Record>& BuildTrace::records() const
+{
+    return mRecords;
+}
+
+void BuildTrace::writeChromeTrace(std::ostream& out) const
+{
+    unsigned long long origin = mRecords.empty() ? 0 : mRecords.front().start;
+
+    //// Pack records into lanes so parallel jobs show up as separate rows =====
+
+    std::vector<unsigned long long> lanes;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+
+    for (size_t i = 0; i < mRecords.size(); ++i)
+    {
+        const Record& record = mRecords.at(i);
+
+        size_t lane = 0;
+
+        while (lane < lanes.size() && lanes.at(lane) > record.start)
+        {
+            ++lane;
+        }
+
+        if (lane == lanes.size())
+        {
+            lanes.push_back(record.end);
+        }
+        else
+        {
+            lanes[lane] = record.end;
+        }
+
+        out << string_format("{\"name\":%s,\"cat\":%s,\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u,",
+                             to_json_string(record.target).c_str(),
+                             to_json_string(record.kind).c_str(),
+                             (record.start - origin) / 1000,
+                             (record.end - record.start) / 1000,
+                             (unsigned int)lane + 1);
+
+        out << string_format("\"args\":{\"config\":%s,\"pid\":%lu}}",
+                             to_json_string(record.config).c_str(),
+                             record.pid);
+
+        out << (i + 1 < mRecords.size() ? "," : "") << std::endl;
+    }
+
+    out << "]}" << std::endl;
+}
+
+void BuildTrace::writeReport(std::ostream& out, size_t top) const
+{
+    unsigned long long first = 0;
+    unsigned long long last  = 0;
+    unsigned long long work  = 0;
+
+    for (const Record& record : mRecords)
+    {
+        if (first == 0 || record.start < first)
+        {
+            first = record.start;
+        }
+
+        last  = std::max(last, record.end);
+        work += record.end - record.start;
+    }
+
+    unsigned long long wall = last - first;
+
+    out << string_format("Records:     %u", (unsigned int)mRecords.size()) << std::endl;
+    out << string_format("Wall time:   %.3f s", (double)wall / 1e9) << std::endl;
+    out << string_format("Total work:  %.3f s", (double)work / 1e9) << std::endl;
+    out << string_format("Parallelism: %.2f", wall > 0 ? (double)work / (double)wall : 0.0) << std::endl;
+    out << std::endl;
+
+    std::vector<Record> slowest = mRecords;
+
+    std::stable_sort(slowest.begin(), slowest.end(), longerRecord);
+
+    if (slowest.size() > top)
+    {
+        slowest.resize(top);
+    }
+
+    for (const Record& record : slowest)
+    {
+        out << string_format("%10.3f s  %-10s %-12s %s",
+                             (double)(record.end - record.start) / 1e9,
+                             record.kind.c_str(),
+                             record.config.c_str(),
+                             record.target.c_str()) << std::endl;
+    }
+}
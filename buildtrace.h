@@ -0,0 +1,40 @@
+#ifndef BUILDTRACE_H
+#define BUILDTRACE_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+class BuildTrace
+{
+public:
+
+    struct Record
+    {
+        unsigned long long start;
+        unsigned long long end;
+        unsigned long      pid;
+        std::string        kind;
+        std::string        config;
+        std::string        target;
+    };
+
+public:
+    BuildTrace();
+
+    bool load(const std::string& path);
+
+    std::string lastError() const;
+
+    const std::vector<Record>& records() const;
+
+    void writeChromeTrace(std::ostream& out) const;
+    void writeReport(std::ostream& out, size_t top) const;
+
+private:
+
+    std::vector<Record> mRecords;
+    std::string         mLastError;
+};
+
+#endif // BUILDTRACE_H
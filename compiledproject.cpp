@@ -0,0 +1,985 @@
+#include "compiledproject.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "utils.h"
+
+static const char sMagic[4] = { 'P', 'J', 'T', 'C' };
+
+#ifdef _WIN32
+static const int sOpenFlags = O_RDONLY | O_BINARY;
+#else
+static const int sOpenFlags = O_RDONLY;
+#endif
+
+// Ranges of a damaged image are cut to the section they point into
+
+static inline PjtcRange clamp_range(PjtcRange range, uint32_t count)
+{
+    if (range.first > count)
+    {
+        range.count = 0;
+    }
+    else if (range.count > count - range.first)
+    {
+        range.count = count - range.first;
+    }
+
+    return range;
+}
+
+static inline int build_condition(uint32_t condition)
+{
+    return (condition < BuildStep::BUILD_CONDITION_COUNT) ? (int)condition : (int)BuildStep::IF_ANY_FILE_BUILDS;
+}
+
+static inline StringRef string_ref(const std::string& str)
+{
+    return StringRef(str);
+}
+
+static inline StringRef string_ref(const InternedString& str)
+{
+    return StringRef(str.str());
+}
+
+//// Image builder =============================================================
+
+class ImageBuilder
+{
+public:
+
+    std::vector<PjtcString>      strings;
+    std::string                  stringData;
+    std::vector<uint32_t>        indexes;
+    std::vector<PjtcStep>        steps;
+    std::vector<PjtcFileOptions> fileOptions;
+    std::vector<PjtcConfig>      configs;
+
+    uint32_t addString(StringRef str)
+    {
+        std::string key = str.str();
+
+        auto found = mStringIds.find(key);
+
+        if (found != mStringIds.end())
+        {
+            return found->second;
+        }
+
+        PjtcString entry;
+        entry.offset = (uint32_t)stringData.size();
+        entry.length = (uint32_t)str.size();
+
+        str.appendTo(stringData);
+        stringData.push_back('\0');
+
+        uint32_t id = (uint32_t)strings.size();
+
+        strings.push_back(entry);
+        mStringIds.insert(std::make_pair(std::move(key), id));
+
+        return id;
+    }
+
+    template <typename Container>
+    PjtcRange addStrings(const Container& list)
+    {
+        PjtcRange range;
+        range.first = (uint32_t)indexes.size();
+        range.count = (uint32_t)list.size();
+
+        for (const auto& str : list)
+        {
+            uint32_t id = addString(string_ref(str));
+            indexes.push_back(id);
+        }
+
+        return range;
+    }
+
+    PjtcRange addSteps(const std::vector<BuildStep>& list)
+    {
+        PjtcRange range;
+        range.first = (uint32_t)steps.size();
+        range.count = (uint32_t)list.size();
+
+        for (const BuildStep& buildStep : list)
+        {
+            PjtcStep step;
+            step.command   = addString(buildStep.command());
+            step.condition = (uint32_t)buildStep.condition();
+
+            steps.push_back(step);
+        }
+
+        return range;
+    }
+
+    // Blocks shared between configurations are stored once
+
+    uint32_t addFileOptions(const FileOptions& options)
+    {
+        auto found = mFileOptionIds.find(&options);
+
+        if (found != mFileOptionIds.end())
+        {
+            return found->second;
+        }
+
+        PjtcFileOptions entry;
+        memset(&entry, 0x00, sizeof(entry));
+
+        entry.linkOrder        = options.linkOrder();
+        entry.excludeFromBuild = options.isExcludedFromBuild() ? 1 : 0;
+        entry.buildCondition   = (uint32_t)options.buildCondition();
+        entry.optionsAdded     = addStrings(options.c_optionsAdded());
+        entry.optionsRemoved   = addStrings(options.c_optionsRemoved());
+        entry.preBuildSteps    = addSteps(options.c_preBuildSteps().c_get());
+        entry.postBuildSteps   = addSteps(options.c_postBuildSteps().c_get());
+
+        uint32_t id = (uint32_t)fileOptions.size();
+
+        fileOptions.push_back(entry);
+        mFileOptionIds.insert(std::make_pair(&options, id));
+
+        return id;
+    }
+
+private:
+
+    std::unordered_map<std::string, uint32_t>        mStringIds;
+    std::unordered_map<const FileOptions*, uint32_t> mFileOptionIds;
+};
+
+template <typename T>
+static PjtcSection append_section(std::string& image, const std::vector<T>& items)
+{
+    PjtcSection section;
+    section.offset = (uint32_t)image.size();
+    section.count  = (uint32_t)items.size();
+
+    if (not items.empty())
+    {
+        image.append(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(T));
+    }
+
+    return section;
+}
+
+void CompiledProject::build(const ProjectSettings& settings, std::string& image)
+{
+    ImageBuilder builder;
+
+    PjtcHeader header;
+    memset(&header, 0x00, sizeof(header));
+
+    memcpy(header.magic, sMagic, sizeof(sMagic));
+
+    header.version     = VERSION;
+    header.byteOrder   = ORDER_MARK;
+
+    //// Global settings =======================================================
+
+    header.projectType = (uint32_t)settings.projectType();
+    header.toolFlags   = settings.toolFlags();
+    header.encoding    = (uint32_t)settings.encoding();
+    header.cpuFamily   = builder.addString(settings.cpuFamily());
+    header.projectDir  = builder.addString(settings.projectDir());
+
+    header.tools       = builder.addStrings(settings.c_tools());
+
+    //// Files by id, including files since removed from the source lists ======
+
+    stringlist files;
+    files.reserve(settings.fileCount());
+
+    for (unsigned int fileId = 0; fileId < settings.fileCount(); ++fileId)
+    {
+        files.push_back(settings.fileName(fileId));
+    }
+
+    header.files       = builder.addStrings(files);
+    header.sources     = builder.addStrings(settings.c_sources());
+    header.commands    = builder.addStrings(settings.c_commands());
+    header.libraries   = builder.addStrings(settings.c_libraries());
+
+    //// Configurations, in name order =========================================
+
+    for (const std::string& configName : settings.configs())
+    {
+        const ConfigSettings& config = settings.c_configSettings(configName);
+
+        PjtcConfig entry;
+        memset(&entry, 0x00, sizeof(entry));
+
+        entry.name                 = builder.addString(configName);
+        entry.outputFile           = builder.addString(config.outputFile());
+        entry.mapFile              = builder.addString(config.mapFile());
+
+        entry.preBuildSteps        = builder.addSteps(config.c_preBuildSteps());
+        entry.postBuildSteps       = builder.addSteps(config.c_postBuildSteps());
+
+        entry.defines              = builder.addStrings(config.c_defines());
+        entry.undefines            = builder.addStrings(config.c_undefines());
+        entry.includePaths         = builder.addStrings(config.c_includePaths());
+        entry.libraryPaths         = builder.addStrings(config.c_libraryPaths());
+        entry.libraries            = builder.addStrings(config.c_libraries());
+        entry.otherCompilerOptions = builder.addStrings(config.c_otherCompilerOptions());
+        entry.otherLinkerOptions   = builder.addStrings(config.c_otherLinkerOptions());
+        entry.otherArchiverOptions = builder.addStrings(config.c_otherArchiverOptions());
+
+        //// One entry per file id ---------------------------------------------
+
+        std::vector<uint32_t> fileOptions(files.size(), NONE);
+
+        for (unsigned int fileId = 0; fileId < files.size(); ++fileId)
+        {
+            const FileOptions& options = config.c_fileOptions(fileId);
+
+            if (not options.isDefault())
+            {
+                fileOptions[fileId] = builder.addFileOptions(options);
+            }
+        }
+
+        entry.fileOptions.first = (uint32_t)builder.indexes.size();
+        entry.fileOptions.count = (uint32_t)fileOptions.size();
+
+        builder.indexes.insert(builder.indexes.end(), fileOptions.begin(), fileOptions.end());
+
+        builder.configs.push_back(entry);
+    }
+
+    //// Layout ================================================================
+
+    image.assign(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // String offsets are known once everything before the text is placed
+
+    size_t stringsOffset = image.size();
+    size_t dataOffset    = stringsOffset + builder.strings.size() * sizeof(PjtcString) +
+                           builder.indexes.size() * sizeof(uint32_t) +
+                           builder.steps.size() * sizeof(PjtcStep) +
+                           builder.fileOptions.size() * sizeof(PjtcFileOptions) +
+                           builder.configs.size() * sizeof(PjtcConfig);
+
+    for (PjtcString& entry : builder.strings)
+    {
+        entry.offset += (uint32_t)dataOffset;
+    }
+
+    header.strings     = append_section(image, builder.strings);
+    header.indexes     = append_section(image, builder.indexes);
+    header.steps       = append_section(image, builder.steps);
+    header.fileOptions = append_section(image, builder.fileOptions);
+    header.configs     = append_section(image, builder.configs);
+
+    header.stringData.offset = (uint32_t)image.size();
+    header.stringData.count  = (uint32_t)builder.stringData.size();
+
+    image.append(builder.stringData);
+
+    image.append((4 - image.size() % 4) % 4, '\0');
+
+    header.size = (uint32_t)image.size();
+
+    memcpy(&image[0], &header, sizeof(header));
+}
+
+//// Compiled project ==========================================================
+
+const uint32_t CompiledProject::VERSION;
+const uint32_t CompiledProject::ORDER_MARK;
+const uint32_t CompiledProject::NONE;
+
+CompiledProject::CompiledProject() :
+    mData(nullptr),
+    mSize(0),
+    mHeader(nullptr),
+    mOwned(false)
+{
+
+}
+
+CompiledProject::~CompiledProject()
+{
+    close();
+}
+
+bool CompiledProject::open(const std::string& path)
+{
+    close();
+
+    mLastError.clear();
+
+    int fd = ::open(path.c_str(), sOpenFlags);
+
+    if (fd < 0)
+    {
+        mLastError = string_format("Failed to open compiled project '%s': '%s'", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat imageStat;
+
+    if (fstat(fd, &imageStat) != 0)
+    {
+        mLastError = string_format("Failed to get compiled project size: '%s'", strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)imageStat.st_size;
+
+    if (size < sizeof(PjtcHeader))
+    {
+        mLastError = string_format("Compiled project '%s' is truncated", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+#ifdef _WIN32
+    //// No mmap, the image is read into an aligned buffer ---------------------
+
+    char* data = static_cast<char*>(malloc(size));
+
+    if (data == nullptr || ::read(fd, data, (unsigned int)size) != (int)size)
+    {
+        mLastError = string_format("Failed to read compiled project '%s'", path.c_str());
+        free(data);
+        ::close(fd);
+        return false;
+    }
+#else
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (data == MAP_FAILED)
+    {
+        mLastError = string_format("Failed to map compiled project '%s': '%s'", path.c_str(), strerror(errno));
+        ::close(fd);
+        return false;
+    }
+#endif
+
+    ::close(fd);
+
+    mData  = static_cast<const char*>(data);
+    mSize  = size;
+    mOwned = true;
+
+    if (not validate())
+    {
+        std::string error = string_format("Compiled project '%s': %s", path.c_str(), mLastError.c_str());
+        close();
+        mLastError = error;
+        return false;
+    }
+
+    return true;
+}
+
+void CompiledProject::close()
+{
+    if (mData != nullptr && mOwned)
+    {
+#ifdef _WIN32
+        free(const_cast<char*>(mData));
+#else
+        munmap(const_cast<char*>(mData), mSize);
+#endif
+    }
+
+    mData   = nullptr;
+    mSize   = 0;
+    mHeader = nullptr;
+    mOwned  = false;
+}
+
+bool CompiledProject::attach(const char* data, size_t size)
+{
+    close();
+
+    mLastError.clear();
+
+    if (size < sizeof(PjtcHeader) || reinterpret_cast<uintptr_t>(data) % 4 != 0)
+    {
+        mLastError = "Compiled project is truncated or misaligned";
+        return false;
+    }
+
+    mData = data;
+    mSize = size;
+
+    if (not validate())
+    {
+        std::string error = "Compiled project: " + mLastError;
+        close();
+        mLastError = error;
+        return false;
+    }
+
+    return true;
+}
+
+bool CompiledProject::isOpen() const
+{
+    return mHeader != nullptr;
+}
+
+std::string CompiledProject::lastError() const
+{
+    return mLastError;
+}
+
+bool CompiledProject::isImage(const char* data, size_t size)
+{
+    return (size >= sizeof(sMagic) && memcmp(data, sMagic, sizeof(sMagic)) == 0);
+}
+
+//// Validation ================================================================
+
+// Only the header and section bounds, so opening costs the same for any size;
+// indexes are checked as they are followed
+
+static bool section_fits(const PjtcSection& section, size_t itemSize, size_t alignment, size_t size)
+{
+    return (section.offset % alignment == 0 &&
+            (uint64_t)section.offset + (uint64_t)section.count * itemSize <= (uint64_t)size);
+}
+
+bool CompiledProject::validate()
+{
+    const PjtcHeader* header = reinterpret_cast<const PjtcHeader*>(mData);
+
+    if (not isImage(mData, mSize))
+    {
+        mLastError = "not a compiled project";
+        return false;
+    }
+
+    if (header->byteOrder != ORDER_MARK)
+    {
+        mLastError = "written on a machine of other byte order";
+        return false;
+    }
+
+    if (header->version != VERSION)
+    {
+        mLastError = string_format("unsupported version %u", (unsigned int)header->version);
+        return false;
+    }
+
+    if (header->size != mSize)
+    {
+        mLastError = "size mismatch";
+        return false;
+    }
+
+    if (not section_fits(header->strings, sizeof(PjtcString), 4, mSize) ||
+        not section_fits(header->stringData, 1, 1, mSize) ||
+        not section_fits(header->indexes, sizeof(uint32_t), 4, mSize) ||
+        not section_fits(header->steps, sizeof(PjtcStep), 4, mSize) ||
+        not section_fits(header->fileOptions, sizeof(PjtcFileOptions), 4, mSize) ||
+        not section_fits(header->configs, sizeof(PjtcConfig), 4, mSize))
+    {
+        mLastError = "section out of bounds";
+        return false;
+    }
+
+    mHeader = header;
+
+    return true;
+}
+
+//// Image access ==============================================================
+
+StringRef CompiledProject::string(uint32_t index) const
+{
+    if (index >= mHeader->strings.count)
+    {
+        return StringRef();
+    }
+
+    const PjtcString& entry = section<PjtcString>(mHeader->strings)[index];
+
+    if ((uint64_t)entry.offset + entry.length >= (uint64_t)mSize)
+    {
+        return StringRef();
+    }
+
+    return StringRef(mData + entry.offset, entry.length);
+}
+
+uint32_t CompiledProject::index(PjtcRange range, size_t i) const
+{
+    if (i >= range.count || (uint64_t)range.first + i >= (uint64_t)mHeader->indexes.count)
+    {
+        return NONE;
+    }
+
+    return section<uint32_t>(mHeader->indexes)[range.first + i];
+}
+
+const PjtcStep* CompiledProject::step(PjtcRange range, size_t i) const
+{
+    if (i >= range.count || (uint64_t)range.first + i >= (uint64_t)mHeader->steps.count)
+    {
+        return nullptr;
+    }
+
+    return &section<PjtcStep>(mHeader->steps)[range.first + i];
+}
+
+const PjtcFileOptions* CompiledProject::fileOptions(uint32_t index) const
+{
+    if (index >= mHeader->fileOptions.count)
+    {
+        return nullptr;
+    }
+
+    return &section<PjtcFileOptions>(mHeader->fileOptions)[index];
+}
+
+//// Global settings ===========================================================
+
+ProjectSettings::Type CompiledProject::projectType() const
+{
+    if (mHeader->projectType > (uint32_t)ProjectSettings::Type::LIBRARY)
+    {
+        return ProjectSettings::Type::UNKNOWN;
+    }
+
+    return (ProjectSettings::Type)mHeader->projectType;
+}
+
+uint32_t CompiledProject::toolFlags() const
+{
+    return mHeader->toolFlags;
+}
+
+TextEncoding CompiledProject::encoding() const
+{
+    if (mHeader->encoding > (uint32_t)TextEncoding::CP1251)
+    {
+        return TextEncoding::ASCII;
+    }
+
+    return (TextEncoding)mHeader->encoding;
+}
+
+StringRef CompiledProject::cpuFamily() const
+{
+    return string(mHeader->cpuFamily);
+}
+
+StringRef CompiledProject::projectDir() const
+{
+    return string(mHeader->projectDir);
+}
+
+CompiledProject::Strings CompiledProject::tools() const
+{
+    return Strings(this, mHeader->tools);
+}
+
+CompiledProject::Strings CompiledProject::sources() const
+{
+    return Strings(this, mHeader->sources);
+}
+
+CompiledProject::Strings CompiledProject::commands() const
+{
+    return Strings(this, mHeader->commands);
+}
+
+CompiledProject::Strings CompiledProject::libraries() const
+{
+    return Strings(this, mHeader->libraries);
+}
+
+//// Files =====================================================================
+
+unsigned int CompiledProject::fileCount() const
+{
+    return clamp_range(mHeader->files, mHeader->indexes.count).count;
+}
+
+StringRef CompiledProject::fileName(unsigned int fileId) const
+{
+    return string(index(mHeader->files, fileId));
+}
+
+//// Configurations ============================================================
+
+unsigned int CompiledProject::configCount() const
+{
+    return mHeader->configs.count;
+}
+
+CompiledProject::Config CompiledProject::config(unsigned int index) const
+{
+    static const PjtcConfig emptyConfig = PjtcConfig();
+
+    if (index >= mHeader->configs.count)
+    {
+        return Config(this, &emptyConfig);
+    }
+
+    return Config(this, &section<PjtcConfig>(mHeader->configs)[index]);
+}
+
+unsigned int CompiledProject::findConfig(StringRef name) const
+{
+    for (unsigned int i = 0; i < configCount(); ++i)
+    {
+        if (config(i).name() == name)
+        {
+            return i;
+        }
+    }
+
+    return NONE;
+}
+
+//// Settings ==================================================================
+
+static void add_steps(BuildStepList& list, const CompiledProject::Steps& steps)
+{
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+        list.add(BuildStep(steps.command(i).str(), (BuildStep::BuildCondition)steps.condition(i)));
+    }
+}
+
+bool CompiledProject::toSettings(ProjectSettings& settings) const
+{
+    settings.clear();
+
+    if (not isOpen())
+    {
+        return false;
+    }
+
+    settings.setProjectType(projectType());
+    settings.setCpuFamily(cpuFamily().str().c_str());
+    settings.setProjectDir(projectDir().str().c_str());
+    settings.setEncoding(encoding());
+
+    Strings tools = this->tools();
+
+    for (size_t i = 0; i < tools.size(); ++i)
+    {
+        settings.addTool(tools[i].str().c_str());
+    }
+
+    //// Files keep their ids --------------------------------------------------
+
+    for (unsigned int fileId = 0; fileId < fileCount(); ++fileId)
+    {
+        settings.addSource(fileName(fileId).str().c_str());
+    }
+
+    std::set<std::string> listed;
+
+    for (const Strings& list : { sources(), commands(), libraries() })
+    {
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            listed.insert(list[i].str());
+        }
+    }
+
+    for (unsigned int fileId = 0; fileId < fileCount(); ++fileId)
+    {
+        std::string name = fileName(fileId).str();
+
+        if (listed.find(name) == listed.end())
+        {
+            settings.removeSource(name.c_str());
+        }
+    }
+
+    //// Configurations --------------------------------------------------------
+
+    for (unsigned int index = 0; index < configCount(); ++index)
+    {
+        Config image = config(index);
+
+        std::string name = image.name().str();
+
+        settings.addConfig(name);
+
+        ConfigSettings& config = settings.config(name);
+
+        add_steps(config.preBuildStepsRef(), image.preBuildSteps());
+        add_steps(config.postBuildStepsRef(), image.postBuildSteps());
+
+        config.addDefines(image.defines().list());
+        config.addUndefines(image.undefines().list());
+        config.addIncludePaths(image.includePaths().list());
+        config.addLibraryPaths(image.libraryPaths().list());
+        config.addLibraries(image.libraries().list());
+        config.addOtherCompilerOptions(image.otherCompilerOptions().list());
+        config.addOtherLinkerOptions(image.otherLinkerOptions().list());
+        config.addOtherArchiverOptions(image.otherArchiverOptions().list());
+
+        config.setOutputFile(image.outputFile().str());
+        config.setMapFile(image.mapFile().str());
+
+        for (unsigned int fileId = 0; fileId < fileCount(); ++fileId)
+        {
+            File file = image.file(fileId);
+
+            if (file.isDefault())
+            {
+                continue;
+            }
+
+            FileOptions& options = config.file(fileId);
+
+            if (file.linkOrder() >= 0)
+            {
+                options.setLinkOrder((unsigned int)file.linkOrder());
+            }
+
+            options.setExcludeFromBuild(file.isExcludedFromBuild());
+            options.setBuildCondition(file.buildCondition());
+
+            Strings added   = file.optionsAdded();
+            Strings removed = file.optionsRemoved();
+
+            for (size_t i = 0; i < added.size(); ++i)
+            {
+                options.addOptionAdded(added[i].str());
+            }
+
+            for (size_t i = 0; i < removed.size(); ++i)
+            {
+                options.addOptionRemoved(removed[i].str());
+            }
+
+            add_steps(options.preBuildSteps(), file.preBuildSteps());
+            add_steps(options.postBuildSteps(), file.postBuildSteps());
+        }
+    }
+
+    settings.freeze();
+
+    return true;
+}
+
+//// ===========================================================================
+//// Views =====================================================================
+//// ===========================================================================
+
+CompiledProject::Strings::Strings(const CompiledProject* project, PjtcRange range) :
+    mProject(project),
+    mRange(clamp_range(range, project->mHeader->indexes.count))
+{
+
+}
+
+size_t CompiledProject::Strings::size() const
+{
+    return mRange.count;
+}
+
+bool CompiledProject::Strings::empty() const
+{
+    return mRange.count == 0;
+}
+
+StringRef CompiledProject::Strings::operator[](size_t i) const
+{
+    return mProject->string(mProject->index(mRange, i));
+}
+
+stringlist CompiledProject::Strings::list() const
+{
+    stringlist result;
+    result.reserve(size());
+
+    for (size_t i = 0; i < size(); ++i)
+    {
+        result.push_back((*this)[i].str());
+    }
+
+    return result;
+}
+
+//// Steps =====================================================================
+
+CompiledProject::Steps::Steps(const CompiledProject* project, PjtcRange range) :
+    mProject(project),
+    mRange(clamp_range(range, project->mHeader->steps.count))
+{
+
+}
+
+size_t CompiledProject::Steps::size() const
+{
+    return mRange.count;
+}
+
+bool CompiledProject::Steps::empty() const
+{
+    return mRange.count == 0;
+}
+
+StringRef CompiledProject::Steps::command(size_t i) const
+{
+    const PjtcStep* step = mProject->step(mRange, i);
+
+    return (step != nullptr) ? mProject->string(step->command) : StringRef();
+}
+
+int CompiledProject::Steps::condition(size_t i) const
+{
+    const PjtcStep* step = mProject->step(mRange, i);
+
+    return build_condition((step != nullptr) ? step->condition : 0);
+}
+
+//// File ======================================================================
+
+CompiledProject::File::File(const CompiledProject* project, const PjtcFileOptions* options) :
+    mProject(project),
+    mOptions(options)
+{
+
+}
+
+bool CompiledProject::File::isDefault() const
+{
+    return mOptions == nullptr;
+}
+
+int CompiledProject::File::linkOrder() const
+{
+    return (mOptions != nullptr) ? mOptions->linkOrder : -1;
+}
+
+bool CompiledProject::File::isExcludedFromBuild() const
+{
+    return (mOptions != nullptr && mOptions->excludeFromBuild != 0);
+}
+
+int CompiledProject::File::buildCondition() const
+{
+    return build_condition((mOptions != nullptr) ? mOptions->buildCondition : 0);
+}
+
+CompiledProject::Strings CompiledProject::File::optionsAdded() const
+{
+    return Strings(mProject, (mOptions != nullptr) ? mOptions->optionsAdded : PjtcRange());
+}
+
+CompiledProject::Strings CompiledProject::File::optionsRemoved() const
+{
+    return Strings(mProject, (mOptions != nullptr) ? mOptions->optionsRemoved : PjtcRange());
+}
+
+CompiledProject::Steps CompiledProject::File::preBuildSteps() const
+{
+    return Steps(mProject, (mOptions != nullptr) ? mOptions->preBuildSteps : PjtcRange());
+}
+
+CompiledProject::Steps CompiledProject::File::postBuildSteps() const
+{
+    return Steps(mProject, (mOptions != nullptr) ? mOptions->postBuildSteps : PjtcRange());
+}
+
+//// Config ====================================================================
+
+CompiledProject::Config::Config(const CompiledProject* project, const PjtcConfig* config) :
+    mProject(project),
+    mConfig(config)
+{
+
+}
+
+StringRef CompiledProject::Config::name() const
+{
+    return mProject->string(mConfig->name);
+}
+
+CompiledProject::Steps CompiledProject::Config::preBuildSteps() const
+{
+    return Steps(mProject, mConfig->preBuildSteps);
+}
+
+CompiledProject::Steps CompiledProject::Config::postBuildSteps() const
+{
+    return Steps(mProject, mConfig->postBuildSteps);
+}
+
+CompiledProject::Strings CompiledProject::Config::defines() const
+{
+    return Strings(mProject, mConfig->defines);
+}
+
+CompiledProject::Strings CompiledProject::Config::undefines() const
+{
+    return Strings(mProject, mConfig->undefines);
+}
+
+CompiledProject::Strings CompiledProject::Config::includePaths() const
+{
+    return Strings(mProject, mConfig->includePaths);
+}
+
+CompiledProject::Strings CompiledProject::Config::libraryPaths() const
+{
+    return Strings(mProject, mConfig->libraryPaths);
+}
+
+CompiledProject::Strings CompiledProject::Config::libraries() const
+{
+    return Strings(mProject, mConfig->libraries);
+}
+
+CompiledProject::Strings CompiledProject::Config::otherCompilerOptions() const
+{
+    return Strings(mProject, mConfig->otherCompilerOptions);
+}
+
+CompiledProject::Strings CompiledProject::Config::otherLinkerOptions() const
+{
+    return Strings(mProject, mConfig->otherLinkerOptions);
+}
+
+CompiledProject::Strings CompiledProject::Config::otherArchiverOptions() const
+{
+    return Strings(mProject, mConfig->otherArchiverOptions);
+}
+
+StringRef CompiledProject::Config::outputFile() const
+{
+    return mProject->string(mConfig->outputFile);
+}
+
+StringRef CompiledProject::Config::mapFile() const
+{
+    return mProject->string(mConfig->mapFile);
+}
+
+CompiledProject::File CompiledProject::Config::file(unsigned int fileId) const
+{
+    return File(mProject, mProject->fileOptions(mProject->index(mConfig->fileOptions, fileId)));
+}
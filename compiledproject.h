@@ -0,0 +1,285 @@
+#ifndef COMPILEDPROJECT_H
+#define COMPILEDPROJECT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "projectsettings.h"
+#include "stringref.h"
+
+//// Image layout ==============================================================
+
+// A compiled project (.pjtc) is one block of 32-bit words in the byte order
+// of the machine that wrote it: the header, then the sections it points to.
+// Offsets are in bytes from the start of the image. Strings are stored once
+// and referred to by index; lists are ranges of the index pool holding
+// string, step or file options indexes. Each configuration has one pool
+// entry per project file id, naming its file options or NONE.
+
+struct PjtcSection
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct PjtcRange
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+struct PjtcString
+{
+    uint32_t offset;    // Followed by a NUL
+    uint32_t length;
+};
+
+struct PjtcStep
+{
+    uint32_t command;
+    uint32_t condition;
+};
+
+struct PjtcFileOptions
+{
+    int32_t   linkOrder;
+    uint32_t  excludeFromBuild;
+    uint32_t  buildCondition;
+    uint32_t  reserved;
+
+    PjtcRange optionsAdded;
+    PjtcRange optionsRemoved;
+    PjtcRange preBuildSteps;    // Ranges of the step section
+    PjtcRange postBuildSteps;
+};
+
+struct PjtcConfig
+{
+    uint32_t  name;
+    uint32_t  outputFile;
+    uint32_t  mapFile;
+    uint32_t  reserved;
+
+    PjtcRange preBuildSteps;    // Ranges of the step section
+    PjtcRange postBuildSteps;
+
+    PjtcRange defines;
+    PjtcRange undefines;
+    PjtcRange includePaths;
+    PjtcRange libraryPaths;
+    PjtcRange libraries;
+    PjtcRange otherCompilerOptions;
+    PjtcRange otherLinkerOptions;
+    PjtcRange otherArchiverOptions;
+
+    PjtcRange fileOptions;
+};
+
+struct PjtcHeader
+{
+    char        magic[4];       // "PJTC"
+    uint32_t    version;
+    uint32_t    byteOrder;
+    uint32_t    size;
+
+    PjtcSection strings;
+    PjtcSection stringData;     // Count in bytes
+    PjtcSection indexes;
+    PjtcSection steps;
+    PjtcSection fileOptions;
+    PjtcSection configs;
+
+    uint32_t    projectType;
+    uint32_t    toolFlags;
+    uint32_t    encoding;
+    uint32_t    cpuFamily;
+    uint32_t    projectDir;
+    uint32_t    reserved;
+
+    PjtcRange   tools;
+    PjtcRange   files;          // By file id
+    PjtcRange   sources;
+    PjtcRange   commands;
+    PjtcRange   libraries;
+};
+
+//// Compiled project ==========================================================
+
+// Read-only view of a compiled project image. The image is mapped, not
+// parsed; only the header and section bounds are checked on open, and every
+// accessor reads straight from the mapping.
+
+class CompiledProject
+{
+public:
+
+    class Strings
+    {
+    public:
+        Strings(const CompiledProject* project, PjtcRange range);
+
+        size_t    size() const;
+        bool      empty() const;
+        StringRef operator[](size_t i) const;
+
+        stringlist list() const;
+
+    private:
+        const CompiledProject* mProject;
+        PjtcRange              mRange;
+    };
+
+    class Steps
+    {
+    public:
+        Steps(const CompiledProject* project, PjtcRange range);
+
+        size_t    size() const;
+        bool      empty() const;
+        StringRef command(size_t i) const;
+        int       condition(size_t i) const;
+
+    private:
+        const CompiledProject* mProject;
+        PjtcRange              mRange;
+    };
+
+    class File
+    {
+    public:
+        File(const CompiledProject* project, const PjtcFileOptions* options);
+
+        bool    isDefault() const;
+
+        int     linkOrder() const;
+        bool    isExcludedFromBuild() const;
+        int     buildCondition() const;
+
+        Strings optionsAdded() const;
+        Strings optionsRemoved() const;
+
+        Steps   preBuildSteps() const;
+        Steps   postBuildSteps() const;
+
+    private:
+        const CompiledProject* mProject;
+        const PjtcFileOptions* mOptions;
+    };
+
+    class Config
+    {
+    public:
+        Config(const CompiledProject* project, const PjtcConfig* config);
+
+        StringRef name() const;
+
+        Steps     preBuildSteps() const;
+        Steps     postBuildSteps() const;
+
+        Strings   defines() const;
+        Strings   undefines() const;
+        Strings   includePaths() const;
+        Strings   libraryPaths() const;
+        Strings   libraries() const;
+        Strings   otherCompilerOptions() const;
+        Strings   otherLinkerOptions() const;
+        Strings   otherArchiverOptions() const;
+
+        StringRef outputFile() const;
+        StringRef mapFile() const;
+
+        File      file(unsigned int fileId) const;
+
+    private:
+        const CompiledProject* mProject;
+        const PjtcConfig*      mConfig;
+    };
+
+    static const uint32_t VERSION    = 1u;
+    static const uint32_t ORDER_MARK = 0x01020304u;
+    static const uint32_t NONE       = 0xFFFFFFFFu;
+
+public:
+    CompiledProject();
+    ~CompiledProject();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Views an image held by the caller, which must stay valid until close
+
+    bool attach(const char* data, size_t size);
+
+    bool isOpen() const;
+
+    std::string lastError() const;
+
+    static bool isImage(const char* data, size_t size);
+
+    // Builds an image of the settings
+
+    static void build(const ProjectSettings& settings, std::string& image);
+
+    // Rebuilds full settings from the image, for the exporters
+
+    bool toSettings(ProjectSettings& settings) const;
+
+    //// Global settings =======================================================
+
+    ProjectSettings::Type projectType() const;
+    uint32_t              toolFlags() const;
+    TextEncoding          encoding() const;
+
+    StringRef cpuFamily() const;
+    StringRef projectDir() const;
+
+    Strings   tools() const;
+    Strings   sources() const;
+    Strings   commands() const;
+    Strings   libraries() const;
+
+    //// Files =================================================================
+
+    unsigned int fileCount() const;
+    StringRef    fileName(unsigned int fileId) const;
+
+    //// Configurations ========================================================
+
+    unsigned int configCount() const;
+    Config       config(unsigned int index) const;
+
+    // Index of a configuration by name, NONE if there is none
+
+    unsigned int findConfig(StringRef name) const;
+
+private:
+
+    const char*       mData;
+    size_t            mSize;
+
+    const PjtcHeader* mHeader;
+
+    bool              mOwned;
+
+    std::string       mLastError;
+
+    bool validate();
+
+    StringRef string(uint32_t index) const;
+    uint32_t  index(PjtcRange range, size_t i) const;
+
+    const PjtcStep*        step(PjtcRange range, size_t i) const;
+    const PjtcFileOptions* fileOptions(uint32_t index) const;
+
+    template <typename T>
+    const T* section(const PjtcSection& section) const
+    {
+        return reinterpret_cast<const T*>(mData + section.offset);
+    }
+
+    CompiledProject(const CompiledProject& other);
+    CompiledProject& operator=(const CompiledProject& other);
+};
+
+#endif // COMPILEDPROJECT_H
@@ -1,10 +1,55 @@
 ﻿#include "configsettings.h"
 
 #include <string.h>
+#include <algorithm>
 
+#include "modelversion.h"
 #include "utils.h"
 
-ConfigSettings::ConfigSettings()
+static bool sameFileOptions(const fileoptionstable& first, const fileoptionstable& second)
+{
+    // Missing entries read as default options
+
+    size_t size = std::max(first.size(), second.size());
+
+    for (size_t fileId = 0; fileId < size; ++fileId)
+    {
+        const CowPtr<FileOptions> defaultOptions;
+
+        const CowPtr<FileOptions>& left  = (fileId < first.size())  ? first[fileId]  : defaultOptions;
+        const CowPtr<FileOptions>& right = (fileId < second.size()) ? second[fileId] : defaultOptions;
+
+        if (left != right)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint64_t hashList(uint64_t seed, const stringlist& list)
+{
+    seed = hash_combine(seed, list.size());
+
+    for (const std::string& item : list)
+    {
+        seed = hash_combine(seed, hash_string(item));
+    }
+
+    return seed;
+}
+
+template <typename T>
+static void shareBlock(CowPtr<T>& block, const CowPtr<T>& other)
+{
+    if (not block.shares(other) && block == other)
+    {
+        block.share(other);
+    }
+}
+
+ConfigSettings::ConfigSettings() : mHash(0), mHashVersion(ModelVersion::NONE)
 {
 
 }
@@ -22,11 +67,33 @@ ConfigSettings::ConfigSettings(const ConfigSettings& other) :
     mOtherArchiverOptions(other.mOtherArchiverOptions),
     mOutputFile(other.mOutputFile),
     mMapFile(other.mMapFile),
-    mFileOptions(other.mFileOptions)
+    mFileOptions(other.mFileOptions),
+    mHash(other.mHash),
+    mHashVersion(other.mHashVersion)
 {
 
 }
 
+ConfigSettings::ConfigSettings(ConfigSettings&& other) noexcept :
+    mPreBuildSteps(std::move(other.mPreBuildSteps)),
+    mPostBuildSteps(std::move(other.mPostBuildSteps)),
+    mDefines(std::move(other.mDefines)),
+    mUndefines(std::move(other.mUndefines)),
+    mIncludePaths(std::move(other.mIncludePaths)),
+    mLibraryPaths(std::move(other.mLibraryPaths)),
+    mLibraries(std::move(other.mLibraries)),
+    mOtherCompilerOptions(std::move(other.mOtherCompilerOptions)),
+    mOtherLinkerOptions(std::move(other.mOtherLinkerOptions)),
+    mOtherArchiverOptions(std::move(other.mOtherArchiverOptions)),
+    mOutputFile(std::move(other.mOutputFile)),
+    mMapFile(std::move(other.mMapFile)),
+    mFileOptions(std::move(other.mFileOptions)),
+    mHash(other.mHash),
+    mHashVersion(other.mHashVersion)
+{
+    ModelVersion::bump();
+}
+
 ConfigSettings&ConfigSettings::operator=(const ConfigSettings& other)
 {
     this->mPreBuildSteps = other.mPreBuildSteps;
@@ -42,12 +109,46 @@ ConfigSettings&ConfigSettings::operator=(const ConfigSettings& other)
     this->mOutputFile = other.mOutputFile;
     this->mMapFile = other.mMapFile;
     this->mFileOptions = other.mFileOptions;
+    this->mHash = other.mHash;
+    this->mHashVersion = other.mHashVersion;
+
+    ModelVersion::bump();
+    clearIndexes();
+
+    return *this;
+}
+
+ConfigSettings& ConfigSettings::operator=(ConfigSettings&& other) noexcept
+{
+    this->mPreBuildSteps = std::move(other.mPreBuildSteps);
+    this->mPostBuildSteps = std::move(other.mPostBuildSteps);
+    this->mDefines = std::move(other.mDefines);
+    this->mUndefines = std::move(other.mUndefines);
+    this->mIncludePaths = std::move(other.mIncludePaths);
+    this->mLibraryPaths = std::move(other.mLibraryPaths);
+    this->mLibraries = std::move(other.mLibraries);
+    this->mOtherCompilerOptions = std::move(other.mOtherCompilerOptions);
+    this->mOtherLinkerOptions = std::move(other.mOtherLinkerOptions);
+    this->mOtherArchiverOptions = std::move(other.mOtherArchiverOptions);
+    this->mOutputFile = std::move(other.mOutputFile);
+    this->mMapFile = std::move(other.mMapFile);
+    this->mFileOptions = std::move(other.mFileOptions);
+    this->mHash = other.mHash;
+    this->mHashVersion = other.mHashVersion;
+
+    ModelVersion::bump();
+    clearIndexes();
 
     return *this;
 }
 
 bool ConfigSettings::operator==(const ConfigSettings& other) const
 {
+    if (this->hash() != other.hash())
+    {
+        return false;
+    }
+
     if (this->mPreBuildSteps != other.mPreBuildSteps)
     {
         return false;
@@ -108,7 +209,7 @@ bool ConfigSettings::operator==(const ConfigSettings& other) const
         return false;
     }
 
-    if (this->mFileOptions != other.mFileOptions)
+    if (not sameFileOptions(*this->mFileOptions, *other.mFileOptions))
     {
         return false;
     }
@@ -123,46 +224,86 @@ bool ConfigSettings::operator!=(const ConfigSettings& other) const
 
 //// Build steps ===============================================================
 
-std::list<BuildStep> ConfigSettings::preBuildSteps() const
+std::vector<BuildStep> ConfigSettings::preBuildSteps() const
+{
+    return mPreBuildSteps->get();
+}
+
+const std::vector<BuildStep>& ConfigSettings::c_preBuildSteps() const
 {
-    return mPreBuildSteps.get();
+    return mPreBuildSteps->c_get();
 }
 
 BuildStepList& ConfigSettings::preBuildStepsRef()
 {
-    return mPreBuildSteps;
+    return modify(mPreBuildSteps);
 }
 
-std::list<BuildStep> ConfigSettings::postBuildSteps() const
+std::vector<BuildStep> ConfigSettings::postBuildSteps() const
 {
-    return mPostBuildSteps.get();
+    return mPostBuildSteps->get();
+}
+
+const std::vector<BuildStep>& ConfigSettings::c_postBuildSteps() const
+{
+    return mPostBuildSteps->c_get();
 }
 
 BuildStepList& ConfigSettings::postBuildStepsRef()
 {
-    return mPostBuildSteps;
+    return modify(mPostBuildSteps);
+}
+
+void ConfigSettings::clearPreBuildSteps()
+{
+    reset(mPreBuildSteps);
+}
+
+void ConfigSettings::clearPostBuildSteps()
+{
+    reset(mPostBuildSteps);
 }
 
 //// Compiler options ==========================================================
 
 stringlist ConfigSettings::defines() const
 {
-    return mDefines;
+    return mDefines.get();
 }
 
 stringlist ConfigSettings::undefines() const
 {
-    return mUndefines;
+    return mUndefines.get();
 }
 
 stringlist ConfigSettings::includePaths() const
 {
-    return mIncludePaths;
+    return mIncludePaths.get();
 }
 
 stringlist ConfigSettings::otherCompilerOptions() const
 {
-    return mOtherCompilerOptions;
+    return mOtherCompilerOptions.get();
+}
+
+cstringlist& ConfigSettings::c_defines() const
+{
+    return mDefines.get();
+}
+
+cstringlist& ConfigSettings::c_undefines() const
+{
+    return mUndefines.get();
+}
+
+cstringlist& ConfigSettings::c_includePaths() const
+{
+    return mIncludePaths.get();
+}
+
+cstringlist& ConfigSettings::c_otherCompilerOptions() const
+{
+    return mOtherCompilerOptions.get();
 }
 
 void ConfigSettings::addCompilerOption(const std::string& option)
@@ -171,19 +312,39 @@ void ConfigSettings::addCompilerOption(const std::string& option)
 
     if (is_flag(option, "-i", value))
     {
-        mIncludePaths.push_back(fixpath(value));
+        modify(mIncludePaths).push_back(fixpath(value));
     }
     else if (is_flag(option, "-d", value))
     {
-        mDefines.push_back(value);
+        modify(mDefines).push_back(value);
     }
     else if (is_flag(option, "-u", value))
     {
-        mUndefines.push_back(value);
+        modify(mUndefines).push_back(value);
+    }
+    else
+    {
+        modify(mOtherCompilerOptions).push_back(option);
+    }
+}
+
+void ConfigSettings::addCompilerOption(const OptionToken& token)
+{
+    if (token.isQuotedFlag("-i"))
+    {
+        modify(mIncludePaths).push_back(fixpath(token.value()));
+    }
+    else if (token.isQuotedFlag("-d"))
+    {
+        modify(mDefines).push_back(token.value());
+    }
+    else if (token.isQuotedFlag("-u"))
+    {
+        modify(mUndefines).push_back(token.value());
     }
     else
     {
-        mOtherCompilerOptions.push_back(option);
+        modify(mOtherCompilerOptions).push_back(token.text());
     }
 }
 
@@ -201,48 +362,48 @@ void ConfigSettings::removeCompilerOption(const std::string& option)
 
     if (is_flag(option, "-i", value))
     {
-        mIncludePaths.remove(fixpath(value));
+        erase_all(modify(mIncludePaths), fixpath(value));
     }
     else if (is_flag(option, "-d", value))
     {
-        mDefines.remove(value);
+        erase_all(modify(mDefines), value);
     }
     else if (is_flag(option, "-u", value))
     {
-        mUndefines.remove(value);
+        erase_all(modify(mUndefines), value);
     }
     else
     {
-        mOtherCompilerOptions.remove(option);
+        erase_all(modify(mOtherCompilerOptions), option);
     }
 }
 
 void ConfigSettings::clearCompilerOptions()
 {
-    mIncludePaths.clear();
-    mDefines.clear();
-    mUndefines.clear();
-    mOtherCompilerOptions.clear();
+    reset(mIncludePaths);
+    reset(mDefines);
+    reset(mUndefines);
+    reset(mOtherCompilerOptions);
 }
 
 void ConfigSettings::addDefine(const std::string& option)
 {
-    mDefines.push_back(option);
+    modify(mDefines).push_back(option);
 }
 
 void ConfigSettings::addUndefine(const std::string& option)
 {
-    mUndefines.push_back(option);
+    modify(mUndefines).push_back(option);
 }
 
 void ConfigSettings::addIncludePath(const std::string& option)
 {
-    mIncludePaths.push_back(fixpath(option));
+    modify(mIncludePaths).push_back(fixpath(option));
 }
 
 void ConfigSettings::addOtherCompilerOption(const std::string& option)
 {
-    mOtherCompilerOptions.push_back(option);
+    modify(mOtherCompilerOptions).push_back(option);
 }
 
 void ConfigSettings::addDefines(const stringlist& options)
@@ -279,59 +440,74 @@ void ConfigSettings::addOtherCompilerOptions(const stringlist& options)
 
 void ConfigSettings::removeDefine(const std::string& option)
 {
-    mDefines.remove(option);
+    erase_all(modify(mDefines), option);
 }
 
 void ConfigSettings::removeUndefine(const std::string& option)
 {
-    mUndefines.remove(option);
+    erase_all(modify(mUndefines), option);
 }
 
 void ConfigSettings::removeIncludePath(const std::string& option)
 {
-    mIncludePaths.remove(fixpath(option));
+    erase_all(modify(mIncludePaths), fixpath(option));
 }
 
 void ConfigSettings::removeOtherCompilerOption(const std::string& option)
 {
-    mOtherCompilerOptions.remove(option);
+    erase_all(modify(mOtherCompilerOptions), option);
 }
 
 void ConfigSettings::clearDefines()
 {
-    mDefines.clear();
+    reset(mDefines);
 }
 
 void ConfigSettings::clearUndefines()
 {
-    mUndefines.clear();
+    reset(mUndefines);
 }
 
 void ConfigSettings::clearIncludePaths()
 {
-    mIncludePaths.clear();
+    reset(mIncludePaths);
 }
 
 void ConfigSettings::clearOtherCompilerOptions()
 {
-    mOtherCompilerOptions.clear();
+    reset(mOtherCompilerOptions);
 }
 
 //// Linker options ============================================================
 
 stringlist ConfigSettings::libraryPaths() const
 {
-    return mLibraryPaths;
+    return mLibraryPaths.get();
 }
 
 stringlist ConfigSettings::libraries() const
 {
-    return mLibraries;
+    return mLibraries.get();
 }
 
 stringlist ConfigSettings::otherLinkerOptions() const
 {
-    return mOtherLinkerOptions;
+    return mOtherLinkerOptions.get();
+}
+
+cstringlist& ConfigSettings::c_libraryPaths() const
+{
+    return mLibraryPaths.get();
+}
+
+cstringlist& ConfigSettings::c_libraries() const
+{
+    return mLibraries.get();
+}
+
+cstringlist& ConfigSettings::c_otherLinkerOptions() const
+{
+    return mOtherLinkerOptions.get();
 }
 
 std::string ConfigSettings::outputFile() const
@@ -350,23 +526,51 @@ void ConfigSettings::addLinkerOption(const std::string& option)
 
     if (is_flag(option, "-i", value))
     {
-        mLibraryPaths.push_back(fixpath(value));
+        modify(mLibraryPaths).push_back(fixpath(value));
     }
     else if (is_flag(option, "-l", value))
     {
-        mLibraries.push_back(fixpath(value));
+        modify(mLibraries).push_back(fixpath(value));
     }
     else if (is_flag(option, "-o", value))
     {
+        ModelVersion::bump();
         mOutputFile = fixpath(value);
     }
     else if (is_flag(option, "-m", value))
     {
+        ModelVersion::bump();
         mMapFile = fixpath(value);
     }
     else
     {
-        mOtherLinkerOptions.push_back(option);
+        modify(mOtherLinkerOptions).push_back(option);
+    }
+}
+
+void ConfigSettings::addLinkerOption(const OptionToken& token)
+{
+    if (token.isQuotedFlag("-i"))
+    {
+        modify(mLibraryPaths).push_back(fixpath(token.value()));
+    }
+    else if (token.isQuotedFlag("-l"))
+    {
+        modify(mLibraries).push_back(fixpath(token.value()));
+    }
+    else if (token.isQuotedFlag("-o"))
+    {
+        ModelVersion::bump();
+        mOutputFile = fixpath(token.value());
+    }
+    else if (token.isQuotedFlag("-m"))
+    {
+        ModelVersion::bump();
+        mMapFile = fixpath(token.value());
+    }
+    else
+    {
+        modify(mOtherLinkerOptions).push_back(token.text());
     }
 }
 
@@ -374,23 +578,25 @@ void ConfigSettings::addLinkerOption(const std::string& flag, const std::string&
 {
     if (flag == "-i")
     {
-        mLibraryPaths.push_back(fixpath(value));
+        modify(mLibraryPaths).push_back(fixpath(value));
     }
     else if (flag == "-l")
     {
-        mLibraries.push_back(fixpath(value));
+        modify(mLibraries).push_back(fixpath(value));
     }
     else if (flag == "-o")
     {
+        ModelVersion::bump();
         mOutputFile = fixpath(value);
     }
     else if (flag == "-m")
     {
+        ModelVersion::bump();
         mMapFile = fixpath(value);
     }
     else
     {
-        mOtherLinkerOptions.push_back(to_option(flag, value, quote));
+        modify(mOtherLinkerOptions).push_back(to_option(flag, value, quote));
     }
 }
 
@@ -408,48 +614,51 @@ void ConfigSettings::removeLinkerOption(const std::string& option)
 
     if (is_flag(option, "-i", value))
     {
-        mLibraryPaths.remove(fixpath(value));
+        erase_all(modify(mLibraryPaths), fixpath(value));
     }
     else if (is_flag(option, "-l", value))
     {
-        mLibraries.remove(fixpath(value));
+        erase_all(modify(mLibraries), fixpath(value));
     }
     else if (is_flag(option, "-o", value))
     {
+        ModelVersion::bump();
         mOutputFile.clear();
     }
     else if (is_flag(option, "-m", value))
     {
+        ModelVersion::bump();
         mMapFile.clear();
     }
     else
     {
-        mOtherLinkerOptions.remove(option);
+        erase_all(modify(mOtherLinkerOptions), option);
     }
 }
 
 void ConfigSettings::clearLinkerOptions()
 {
-    mLibraryPaths.clear();
-    mLibraries.clear();
-    mOtherLinkerOptions.clear();
+    reset(mLibraryPaths);
+    reset(mLibraries);
+    reset(mOtherLinkerOptions);
+    ModelVersion::bump();
     mOutputFile.clear();
     mMapFile.clear();
 }
 
 void ConfigSettings::addLibraryPath(const std::string& option)
 {
-    mLibraryPaths.push_back(fixpath(option));
+    modify(mLibraryPaths).push_back(fixpath(option));
 }
 
 void ConfigSettings::addLibrary(const std::string& option)
 {
-    mLibraries.push_back(fixpath(option));
+    modify(mLibraries).push_back(fixpath(option));
 }
 
 void ConfigSettings::addOtherLinkerOption(const std::string& option)
 {
-    mOtherLinkerOptions.push_back(option);
+    modify(mOtherLinkerOptions).push_back(option);
 }
 
 void ConfigSettings::addLibraryPaths(const stringlist& options)
@@ -478,41 +687,43 @@ void ConfigSettings::addOtherLinkerOptions(const stringlist& options)
 
 void ConfigSettings::removeLibraryPath(const std::string& option)
 {
-    mLibraryPaths.remove(fixpath(option));
+    erase_all(modify(mLibraryPaths), fixpath(option));
 }
 
 void ConfigSettings::removeLibrary(const std::string& option)
 {
-    mLibraries.remove(fixpath(option));
+    erase_all(modify(mLibraries), fixpath(option));
 }
 
 void ConfigSettings::removeOtherLinkerOption(const std::string& option)
 {
-    mOtherLinkerOptions.remove(option);
+    erase_all(modify(mOtherLinkerOptions), option);
 }
 
 void ConfigSettings::clearLibraryPaths()
 {
-    mLibraryPaths.clear();
+    reset(mLibraryPaths);
 }
 
 void ConfigSettings::clearLibraries()
 {
-    mLibraries.clear();
+    reset(mLibraries);
 }
 
 void ConfigSettings::clearOtherLinkerOptions()
 {
-    mOtherLinkerOptions.clear();
+    reset(mOtherLinkerOptions);
 }
 
 void ConfigSettings::setOutputFile(const std::string& option)
 {
+    ModelVersion::bump();
     mOutputFile = fixpath(option);
 }
 
 void ConfigSettings::setMapFile(const std::string& option)
 {
+    ModelVersion::bump();
     mMapFile = fixpath(option);
 }
 
@@ -520,12 +731,22 @@ void ConfigSettings::setMapFile(const std::string& option)
 
 stringlist ConfigSettings::otherArchiverOptions() const
 {
-    return mOtherArchiverOptions;
+    return mOtherArchiverOptions.get();
+}
+
+cstringlist& ConfigSettings::c_otherArchiverOptions() const
+{
+    return mOtherArchiverOptions.get();
 }
 
 void ConfigSettings::addArchiverOption(const char* option)
 {
-    mOtherArchiverOptions.push_back(option);
+    modify(mOtherArchiverOptions).push_back(option);
+}
+
+void ConfigSettings::addArchiverOption(const OptionToken& token)
+{
+    modify(mOtherArchiverOptions).push_back(token.text());
 }
 
 void ConfigSettings::addArchiverOptions(const stringlist& options)
@@ -538,17 +759,17 @@ void ConfigSettings::addArchiverOptions(const stringlist& options)
 
 void ConfigSettings::removeArchiverOption(const char* option)
 {
-    mOtherArchiverOptions.remove(option);
+    erase_all(modify(mOtherArchiverOptions), option);
 }
 
 void ConfigSettings::clearArchiverOptions()
 {
-    mOtherArchiverOptions.clear();
+    reset(mOtherArchiverOptions);
 }
 
 void ConfigSettings::addOtherArchiverOption(const std::string& option)
 {
-    mOtherArchiverOptions.push_back(option);
+    modify(mOtherArchiverOptions).push_back(option);
 }
 
 void ConfigSettings::addOtherArchiverOptions(const stringlist& options)
@@ -561,85 +782,243 @@ void ConfigSettings::addOtherArchiverOptions(const stringlist& options)
 
 void ConfigSettings::removeOtherArchiverOption(const std::string& option)
 {
-    mOtherArchiverOptions.remove(option);
+    erase_all(modify(mOtherArchiverOptions), option);
 }
 
 void ConfigSettings::clearOtherArchiverOptions()
 {
-    mOtherArchiverOptions.clear();
+    reset(mOtherArchiverOptions);
 }
 
 //// Custom files compiler options =============================================
 
-FileOptions ConfigSettings::fileOptions(const std::string& file) const
+FileOptions ConfigSettings::fileOptions(unsigned int fileId) const
+{
+    return c_fileOptions(fileId);
+}
+
+const FileOptions& ConfigSettings::c_fileOptions(unsigned int fileId) const
 {
-    std::string fileFixed = fixpath(file);
+    static const FileOptions defaultOptions;
 
-    if (mFileOptions.find(fileFixed) != mFileOptions.end())
+    if (fileId < mFileOptions->size())
     {
-        return mFileOptions.at(fileFixed);
+        return (*mFileOptions)[fileId].get();
     }
     else
     {
-        return FileOptions();
+        return defaultOptions;
     }
 }
 
-FileOptions&ConfigSettings::file(const std::string& file)
+FileOptions&ConfigSettings::file(unsigned int fileId)
 {
-    return mFileOptions[fixpath(file)];
+    fileoptionstable& fileOptions = modify(mFileOptions);
+
+    if (fileId >= fileOptions.size())
+    {
+        fileOptions.resize(fileId + 1);
+    }
+
+    return fileOptions[fileId].mutate();
 }
 
-void ConfigSettings::clearFileLinkOrder()
+void ConfigSettings::clearFileOptions(unsigned int fileId)
 {
-    for (auto& file : mFileOptions)
+    if (fileId < mFileOptions->size())
     {
-        file.second.removeLinkOrder();
+        modify(mFileOptions)[fileId].reset();
     }
 }
 
-std::string ConfigSettings::compilerOption(const std::string& key, const std::string& defaultValue) const
+void ConfigSettings::clearFileLinkOrder()
 {
-    return getOption(mOtherCompilerOptions, key, defaultValue);
+    fileoptionstable& fileOptions = modify(mFileOptions);
+
+    for (CowPtr<FileOptions>& file : fileOptions)
+    {
+        if (file->linkOrder() >= 0)
+        {
+            file.mutate().removeLinkOrder();
+        }
+    }
 }
 
-std::string ConfigSettings::linkerOption(const std::string& key, const std::string& defaultValue) const
+//// Structural sharing ========================================================
+
+void ConfigSettings::freeze()
 {
-    return getOption(mOtherLinkerOptions, key, defaultValue);
+    if (mFileOptions->empty())
+    {
+        return;
+    }
+
+    //// Files without overrides at the end need no entries -------------------
+
+    fileoptionstable& fileOptions = modify(mFileOptions);
+
+    while (not fileOptions.empty() && fileOptions.back().isNull())
+    {
+        fileOptions.pop_back();
+    }
+
+    fileOptions.shrink_to_fit();
 }
 
-std::string ConfigSettings::archiverOption(const std::string& key, const std::string& defaultValue) const
+void ConfigSettings::shareBlocks(const ConfigSettings& other)
 {
-    return getOption(mOtherArchiverOptions, key, defaultValue);
+    shareBlock(mPreBuildSteps, other.mPreBuildSteps);
+    shareBlock(mPostBuildSteps, other.mPostBuildSteps);
+    shareBlock(mDefines, other.mDefines);
+    shareBlock(mUndefines, other.mUndefines);
+    shareBlock(mIncludePaths, other.mIncludePaths);
+    shareBlock(mLibraryPaths, other.mLibraryPaths);
+    shareBlock(mLibraries, other.mLibraries);
+    shareBlock(mOtherCompilerOptions, other.mOtherCompilerOptions);
+    shareBlock(mOtherLinkerOptions, other.mOtherLinkerOptions);
+    shareBlock(mOtherArchiverOptions, other.mOtherArchiverOptions);
+    shareBlock(mFileOptions, other.mFileOptions);
 }
 
-std::string ConfigSettings::getOption(const stringlist& options, const std::string& key, const std::string& defaultValue) const
+void ConfigSettings::shareFileOptions(std::unordered_map<uint64_t, std::vector<CowPtr<FileOptions> > >& blocks)
 {
-    for (const std::string& option : options)
+    if (mFileOptions->empty())
     {
-        std::string value;
+        return;
+    }
 
-        if (not starts_with(option, key, true))
+    for (CowPtr<FileOptions>& file : modify(mFileOptions))
+    {
+        if (file.isNull())
         {
             continue;
         }
 
-        std::string::size_type optionLen = key.length();
-        if ((option.length() > optionLen) && (option.at(optionLen) == '='))
+        std::vector<CowPtr<FileOptions> >& bucket = blocks[file->hash()];
+
+        bool shared = false;
+
+        for (const CowPtr<FileOptions>& block : bucket)
+        {
+            if (block == file)
+            {
+                file.share(block);
+                shared = true;
+                break;
+            }
+        }
+
+        if (not shared)
         {
-            value = option.data() + optionLen + 1;
+            bucket.push_back(file);
         }
-        else
+    }
+}
+
+//// Structural hash ===========================================================
+
+uint64_t ConfigSettings::hash() const
+{
+    if (mHashVersion == ModelVersion::current())
+    {
+        return mHash;
+    }
+
+    uint64_t result = 0;
+
+    result = hash_combine(result, mPreBuildSteps->hash());
+    result = hash_combine(result, mPostBuildSteps->hash());
+
+    result = hashList(result, *mDefines);
+    result = hashList(result, *mUndefines);
+    result = hashList(result, *mIncludePaths);
+    result = hashList(result, *mLibraryPaths);
+    result = hashList(result, *mLibraries);
+    result = hashList(result, *mOtherCompilerOptions);
+    result = hashList(result, *mOtherLinkerOptions);
+    result = hashList(result, *mOtherArchiverOptions);
+
+    result = hash_combine(result, hash_string(mOutputFile));
+    result = hash_combine(result, hash_string(mMapFile));
+
+    //// Files with default options do not count, like missing entries --------
+
+    const fileoptionstable& fileOptions = *mFileOptions;
+
+    for (size_t fileId = 0; fileId < fileOptions.size(); ++fileId)
+    {
+        if (fileOptions[fileId].isNull() || fileOptions[fileId]->isDefault())
         {
-            value = option.data() + optionLen;
+            continue;
         }
 
-        remove_quotes(value);
+        result = hash_combine(result, fileId);
+        result = hash_combine(result, fileOptions[fileId]->hash());
+    }
+
+    mHash        = result;
+    mHashVersion = ModelVersion::current();
+
+    return mHash;
+}
+
+std::string ConfigSettings::compilerOption(const std::string& key, const std::string& defaultValue) const
+{
+    return getOption(mCompilerIndex, *mOtherCompilerOptions, key, defaultValue);
+}
+
+std::string ConfigSettings::linkerOption(const std::string& key, const std::string& defaultValue) const
+{
+    return getOption(mLinkerIndex, *mOtherLinkerOptions, key, defaultValue);
+}
+
+std::string ConfigSettings::archiverOption(const std::string& key, const std::string& defaultValue) const
+{
+    return getOption(mArchiverIndex, *mOtherArchiverOptions, key, defaultValue);
+}
+
+const optionpairs& ConfigSettings::compilerOptionPairs() const
+{
+    return builtIndex(mCompilerIndex, *mOtherCompilerOptions).pairs();
+}
+
+const optionpairs& ConfigSettings::linkerOptionPairs() const
+{
+    return builtIndex(mLinkerIndex, *mOtherLinkerOptions).pairs();
+}
+
+const optionpairs& ConfigSettings::archiverOptionPairs() const
+{
+    return builtIndex(mArchiverIndex, *mOtherArchiverOptions).pairs();
+}
+
+OptionIndex& ConfigSettings::builtIndex(OptionIndex& index, const stringlist& options) const
+{
+    if (not index.isBuilt())
+    {
+        index.build(options);
+    }
+
+    return index;
+}
+
+std::string ConfigSettings::getOption(OptionIndex& index, const stringlist& options, const std::string& key, const std::string& defaultValue) const
+{
+    std::string value;
 
+    if (builtIndex(index, options).find(key, value))
+    {
         return value;
     }
 
     return defaultValue;
 }
 
+void ConfigSettings::clearIndexes()
+{
+    mCompilerIndex.clear();
+    mLinkerIndex.clear();
+    mArchiverIndex.clear();
+}
+
 
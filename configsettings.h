@@ -3,15 +3,21 @@
 
 #include <set>
 #include <map>
-#include <list>
+#include <vector>
+#include <unordered_map>
 
 #include "buildsteplist.h"
+#include "cowptr.h"
 #include "fileoptions.h"
+#include "modelversion.h"
+#include "optionindex.h"
+#include "optionlexer.h"
 
 typedef std::set<std::string> stringset;
-typedef std::list<std::string> stringlist;
+typedef std::vector<std::string> stringlist;
 
 typedef const stringset cstringset;
+typedef const stringlist cstringlist;
 
 typedef std::map<std::string, stringset> stringsetmap;
 typedef std::map<std::string, stringlist> stringlistmap;
@@ -22,18 +28,25 @@ public:
 
     ConfigSettings();
     ConfigSettings(const ConfigSettings& other);
+    ConfigSettings(ConfigSettings&& other) noexcept;
 
     ConfigSettings& operator=(const ConfigSettings& other);
+    ConfigSettings& operator=(ConfigSettings&& other) noexcept;
     bool operator==(const ConfigSettings& other) const;
     bool operator!=(const ConfigSettings& other) const;
 
     //// Build steps ===========================================================
 
-    std::list<BuildStep> preBuildSteps() const;
-    BuildStepList&       preBuildStepsRef();
+    std::vector<BuildStep>        preBuildSteps() const;
+    const std::vector<BuildStep>& c_preBuildSteps() const;
+    BuildStepList&                preBuildStepsRef();
 
-    std::list<BuildStep> postBuildSteps() const;
-    BuildStepList&       postBuildStepsRef();
+    std::vector<BuildStep>        postBuildSteps() const;
+    const std::vector<BuildStep>& c_postBuildSteps() const;
+    BuildStepList&                postBuildStepsRef();
+
+    void clearPreBuildSteps();
+    void clearPostBuildSteps();
 
     //// Compiler options ======================================================
 
@@ -42,7 +55,13 @@ public:
     stringlist includePaths() const;
     stringlist otherCompilerOptions() const;
 
+    cstringlist& c_defines() const;
+    cstringlist& c_undefines() const;
+    cstringlist& c_includePaths() const;
+    cstringlist& c_otherCompilerOptions() const;
+
     void addCompilerOption(const std::string& option);
+    void addCompilerOption(const OptionToken& token);
     void addCompilerOptions(const stringlist& options);
     void removeCompilerOption(const std::string& option);
     void clearCompilerOptions();
@@ -73,10 +92,15 @@ public:
     stringlist libraries() const;
     stringlist otherLinkerOptions() const;
 
+    cstringlist& c_libraryPaths() const;
+    cstringlist& c_libraries() const;
+    cstringlist& c_otherLinkerOptions() const;
+
     std::string outputFile() const;
     std::string mapFile() const;
 
     void addLinkerOption(const std::string& option);
+    void addLinkerOption(const OptionToken& token);
     void addLinkerOption(const std::string& flag, const std::string& value, bool quote);
     void addLinkerOptions(const stringlist& options);
     void removeLinkerOption(const std::string& option);
@@ -103,9 +127,11 @@ public:
 
     //// Archiver options ======================================================
 
-    stringlist otherArchiverOptions() const;
+    stringlist   otherArchiverOptions() const;
+    cstringlist& c_otherArchiverOptions() const;
 
     void addArchiverOption(const char* option);
+    void addArchiverOption(const OptionToken& token);
     void addArchiverOptions(const stringlist& options);
     void removeArchiverOption(const char* option);
     void clearArchiverOptions();
@@ -120,39 +146,91 @@ public:
 
     //// Custom files compiler options =========================================
 
-    FileOptions fileOptions(const std::string& file) const;
-    FileOptions& file(const std::string& file);
+    FileOptions        fileOptions(unsigned int fileId) const;
+    const FileOptions& c_fileOptions(unsigned int fileId) const;
+    FileOptions&       file(unsigned int fileId);
 
+    void clearFileOptions(unsigned int fileId);
     void clearFileLinkOrder();
 
+    //// Structural sharing ====================================================
+
+    void freeze();
+    void shareBlocks(const ConfigSettings& other);
+    void shareFileOptions(std::unordered_map<uint64_t, std::vector<CowPtr<FileOptions> > >& blocks);
+
+    //// Structural hash =======================================================
+
+    // Cached until the model version moves on, which any change to the
+    // settings does, including one through preBuildStepsRef() or file()
+
+    uint64_t hash() const;
+
     //// Options getters =======================================================
 
     std::string compilerOption(const std::string& key, const std::string& defaultValue = std::string()) const;
     std::string linkerOption(const std::string& key, const std::string& defaultValue = std::string()) const;
     std::string archiverOption(const std::string& key, const std::string& defaultValue = std::string()) const;
 
+    // Every option split into flag and value, the flag ending at '=' or an
+    // attached quoted value; other options come with an empty value
+
+    const optionpairs& compilerOptionPairs() const;
+    const optionpairs& linkerOptionPairs() const;
+    const optionpairs& archiverOptionPairs() const;
+
 private:
 
-    BuildStepList mPreBuildSteps;
-    BuildStepList mPostBuildSteps;
+    CowPtr<BuildStepList> mPreBuildSteps;
+    CowPtr<BuildStepList> mPostBuildSteps;
 
-    stringlist mDefines;
-    stringlist mUndefines;
-    stringlist mIncludePaths;
+    CowPtr<stringlist> mDefines;
+    CowPtr<stringlist> mUndefines;
+    CowPtr<stringlist> mIncludePaths;
 
-    stringlist mLibraryPaths;
-    stringlist mLibraries;
+    CowPtr<stringlist> mLibraryPaths;
+    CowPtr<stringlist> mLibraries;
 
-    stringlist mOtherCompilerOptions;
-    stringlist mOtherLinkerOptions;
-    stringlist mOtherArchiverOptions;
+    CowPtr<stringlist> mOtherCompilerOptions;
+    CowPtr<stringlist> mOtherLinkerOptions;
+    CowPtr<stringlist> mOtherArchiverOptions;
 
     std::string mOutputFile;
     std::string mMapFile;
 
-    std::map<std::string, FileOptions> mFileOptions;
+    CowPtr<fileoptionstable> mFileOptions;
+
+    mutable uint64_t mHash;
+    mutable uint64_t mHashVersion;      // Model version the hash was taken at
+
+    // Lookup caches, not copied with the settings
+
+    mutable OptionIndex mCompilerIndex;
+    mutable OptionIndex mLinkerIndex;
+    mutable OptionIndex mArchiverIndex;
+
+    OptionIndex& builtIndex(OptionIndex& index, const stringlist& options) const;
+    std::string getOption(OptionIndex& index, const stringlist& options, const std::string& key, const std::string& defaultValue) const;
+
+    void clearIndexes();
+
+    // Every modification goes through these, so the cached hash is dropped
+
+    template <typename T>
+    T& modify(CowPtr<T>& block)
+    {
+        ModelVersion::bump();
+        clearIndexes();
+        return block.mutate();
+    }
 
-    std::string getOption(const stringlist& options, const std::string& key, const std::string& defaultValue) const;
+    template <typename T>
+    void reset(CowPtr<T>& block)
+    {
+        ModelVersion::bump();
+        clearIndexes();
+        block.reset();
+    }
 
 };
 
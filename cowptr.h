@@ -0,0 +1,97 @@
+#ifndef COWPTR_H
+#define COWPTR_H
+
+#include <memory>
+
+#include "arena.h"
+
+// Shared immutable block with copy-on-write. Copies share the block until one
+// of them calls mutate(). A null block reads as a default constructed value.
+
+template <typename T>
+class CowPtr
+{
+public:
+    CowPtr()
+    {
+
+    }
+
+    explicit CowPtr(const T& value) :
+        mData(std::allocate_shared<T>(ArenaAllocator<T>(), value))
+    {
+
+    }
+
+    bool operator==(const CowPtr& other) const
+    {
+        return shares(other) || get() == other.get();
+    }
+
+    bool operator!=(const CowPtr& other) const
+    {
+        return !(*this == other);
+    }
+
+    const T& operator*() const
+    {
+        return get();
+    }
+
+    const T* operator->() const
+    {
+        return &get();
+    }
+
+    const T& get() const
+    {
+        if (mData)
+        {
+            return *mData;
+        }
+
+        static const T empty;
+
+        return empty;
+    }
+
+    T& mutate()
+    {
+        if (not mData)
+        {
+            mData = std::allocate_shared<T>(ArenaAllocator<T>());
+        }
+        else if (mData.use_count() > 1)
+        {
+            mData = std::allocate_shared<T>(ArenaAllocator<T>(), *mData);
+        }
+
+        return *mData;
+    }
+
+    void reset()
+    {
+        mData.reset();
+    }
+
+    bool isNull() const
+    {
+        return not mData;
+    }
+
+    bool shares(const CowPtr& other) const
+    {
+        return mData == other.mData;
+    }
+
+    void share(const CowPtr& other)
+    {
+        mData = other.mData;
+    }
+
+private:
+
+    std::shared_ptr<T> mData;
+};
+
+#endif // COWPTR_H
@@ -0,0 +1,365 @@
+#include "encoding.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//// CP1251 table ==============================================================
+
+// Code points of bytes 0x80-0xff, 0x98 has none in CP1251
+
+static const unsigned short sCp1251High[128] =
+{
+    0x0402, 0x0403, 0x201a, 0x0453, 0x201e, 0x2026, 0x2020, 0x2021,
+    0x20ac, 0x2030, 0x0409, 0x2039, 0x040a, 0x040c, 0x040b, 0x040f,
+    0x0452, 0x2018, 0x2019, 0x201c, 0x201d, 0x2022, 0x2013, 0x2014,
+    0xfffd, 0x2122, 0x0459, 0x203a, 0x045a, 0x045c, 0x045b, 0x045f,
+    0x00a0, 0x040e, 0x045e, 0x0408, 0x00a4, 0x0490, 0x00a6, 0x00a7,
+    0x0401, 0x00a9, 0x0404, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x0407,
+    0x00b0, 0x00b1, 0x0406, 0x0456, 0x0491, 0x00b5, 0x00b6, 0x00b7,
+    0x0451, 0x2116, 0x0454, 0x00bb, 0x0458, 0x0405, 0x0455, 0x0457,
+    0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
+    0x0418, 0x0419, 0x041a, 0x041b, 0x041c, 0x041d, 0x041e, 0x041f,
+    0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
+    0x0428, 0x0429, 0x042a, 0x042b, 0x042c, 0x042d, 0x042e, 0x042f,
+    0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
+    0x0438, 0x0439, 0x043a, 0x043b, 0x043c, 0x043d, 0x043e, 0x043f,
+    0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
+    0x0448, 0x0449, 0x044a, 0x044b, 0x044c, 0x044d, 0x044e, 0x044f
+};
+
+struct Utf8Sequence
+{
+    unsigned char length;
+    char          bytes[3];
+};
+
+struct Cp1251Byte
+{
+    unsigned short codePoint;
+    unsigned char  byte;
+
+    bool operator<(const Cp1251Byte& other) const
+    {
+        return codePoint < other.codePoint;
+    }
+};
+
+struct Utf8Table
+{
+    Utf8Sequence sequences[128];
+
+    Utf8Table()
+    {
+        for (unsigned int i = 0; i < 128; ++i)
+        {
+            unsigned int c = sCp1251High[i];
+
+            if (c < 0x800)
+            {
+                sequences[i].length   = 2;
+                sequences[i].bytes[0] = (char)(0xc0 | (c >> 6));
+                sequences[i].bytes[1] = (char)(0x80 | (c & 0x3f));
+            }
+            else
+            {
+                sequences[i].length   = 3;
+                sequences[i].bytes[0] = (char)(0xe0 | (c >> 12));
+                sequences[i].bytes[1] = (char)(0x80 | ((c >> 6) & 0x3f));
+                sequences[i].bytes[2] = (char)(0x80 | (c & 0x3f));
+            }
+        }
+    }
+};
+
+struct Cp1251Table
+{
+    Cp1251Byte bytes[128];
+
+    Cp1251Table()
+    {
+        for (unsigned int i = 0; i < 128; ++i)
+        {
+            bytes[i].codePoint = sCp1251High[i];
+            bytes[i].byte      = (unsigned char)(0x80 + i);
+        }
+
+        std::sort(bytes, bytes + 128);
+    }
+};
+
+static const Utf8Sequence* utf8_sequences()
+{
+    static const Utf8Table table;
+
+    return table.sequences;
+}
+
+static const Cp1251Byte* cp1251_bytes()
+{
+    static const Cp1251Table table;
+
+    return table.bytes;
+}
+
+//// ASCII runs ================================================================
+
+// Length of the leading run of bytes below 0x80, 16 bytes at a time with SSE2
+// and 8 at a time otherwise
+
+static size_t ascii_prefix(const char* data, size_t size)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(block);
+
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz((unsigned int)mask);
+        }
+    }
+#endif
+
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t block;
+        memcpy(&block, data + i, sizeof(block));
+
+        if ((block & 0x8080808080808080ull) != 0)
+        {
+            break;
+        }
+    }
+
+    while (i < size && (unsigned char)data[i] < 0x80)
+    {
+        ++i;
+    }
+
+    return i;
+}
+
+//// Detection =================================================================
+
+bool is_ascii(const char* data, size_t size)
+{
+    return ascii_prefix(data, size) == size;
+}
+
+bool is_utf8(const char* data, size_t size)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    size_t i = 0;
+
+    while (true)
+    {
+        i += ascii_prefix(data + i, size - i);
+
+        if (i == size)
+        {
+            return true;
+        }
+
+        unsigned char c = bytes[i];
+
+        size_t        length;
+        unsigned char low  = 0x80;
+        unsigned char high = 0xbf;
+
+        if (c < 0xc2)
+        {
+            return false;
+        }
+        else if (c < 0xe0)
+        {
+            length = 2;
+        }
+        else if (c < 0xf0)
+        {
+            length = 3;
+            low    = (c == 0xe0) ? 0xa0 : 0x80;   // Overlong
+            high   = (c == 0xed) ? 0x9f : 0xbf;   // Surrogates
+        }
+        else if (c < 0xf5)
+        {
+            length = 4;
+            low    = (c == 0xf0) ? 0x90 : 0x80;   // Overlong
+            high   = (c == 0xf4) ? 0x8f : 0xbf;   // Past U+10FFFF
+        }
+        else
+        {
+            return false;
+        }
+
+        if (size - i < length || bytes[i + 1] < low || bytes[i + 1] > high)
+        {
+            return false;
+        }
+
+        for (size_t k = 2; k < length; ++k)
+        {
+            if ((bytes[i + k] & 0xc0) != 0x80)
+            {
+                return false;
+            }
+        }
+
+        i += length;
+    }
+}
+
+bool has_utf8_bom(const char* data, size_t size)
+{
+    return (size >= 3 && memcmp(data, "\xef\xbb\xbf", 3) == 0);
+}
+
+TextEncoding detect_encoding(const char* data, size_t size)
+{
+    if (has_utf8_bom(data, size))
+    {
+        return TextEncoding::UTF8;
+    }
+
+    if (is_ascii(data, size))
+    {
+        return TextEncoding::ASCII;
+    }
+
+    if (is_utf8(data, size))
+    {
+        return TextEncoding::UTF8;
+    }
+
+    return TextEncoding::CP1251;
+}
+
+const char* encoding_name(TextEncoding encoding)
+{
+    switch (encoding)
+    {
+    case TextEncoding::ASCII:
+        return "ASCII";
+
+    case TextEncoding::UTF8:
+        return "UTF-8";
+
+    case TextEncoding::CP1251:
+        return "CP1251";
+    }
+
+    return "Unknown";
+}
+
+//// Transcoding ===============================================================
+
+void cp1251_to_utf8(const char* data, size_t size, std::string& out)
+{
+    const Utf8Sequence* sequences = utf8_sequences();
+
+    out.reserve(out.size() + size + size / 2);
+
+    size_t i = 0;
+
+    while (i < size)
+    {
+        size_t run = ascii_prefix(data + i, size - i);
+
+        out.append(data + i, run);
+        i += run;
+
+        for (; i < size && (unsigned char)data[i] >= 0x80; ++i)
+        {
+            const Utf8Sequence& sequence = sequences[(unsigned char)data[i] - 0x80];
+            out.append(sequence.bytes, sequence.length);
+        }
+    }
+}
+
+std::string cp1251_to_utf8(StringRef text)
+{
+    std::string result;
+
+    cp1251_to_utf8(text.data(), text.length(), result);
+
+    return result;
+}
+
+void utf8_to_cp1251(const char* data, size_t size, std::string& out)
+{
+    const Cp1251Byte* bytes = cp1251_bytes();
+
+    const unsigned char* input = reinterpret_cast<const unsigned char*>(data);
+
+    out.reserve(out.size() + size);
+
+    size_t i = 0;
+
+    while (i < size)
+    {
+        size_t run = ascii_prefix(data + i, size - i);
+
+        out.append(data + i, run);
+        i += run;
+
+        if (i == size)
+        {
+            break;
+        }
+
+        //// Decode one multibyte character, bad bytes count as one each -----
+
+        unsigned int codePoint = 0;
+        size_t       length    = 1;
+
+        if (input[i] >= 0xc0 && input[i] < 0xe0 && i + 1 < size)
+        {
+            codePoint = ((input[i] & 0x1fu) << 6) | (input[i + 1] & 0x3fu);
+            length    = 2;
+        }
+        else if (input[i] >= 0xe0 && input[i] < 0xf0 && i + 2 < size)
+        {
+            codePoint = ((input[i] & 0x0fu) << 12) | ((input[i + 1] & 0x3fu) << 6) | (input[i + 2] & 0x3fu);
+            length    = 3;
+        }
+        else if (input[i] >= 0xf0 && input[i] < 0xf8 && i + 3 < size)
+        {
+            length    = 4;
+        }
+
+        i += length;
+
+        Cp1251Byte key;
+        key.codePoint = (unsigned short)codePoint;
+        key.byte      = 0;
+
+        const Cp1251Byte* found = std::lower_bound(bytes, bytes + 128, key);
+
+        if (codePoint != 0 && codePoint < 0x10000 && codePoint != 0xfffd &&
+            found != bytes + 128 && found->codePoint == codePoint)
+        {
+            out.push_back((char)found->byte);
+        }
+        else
+        {
+            out.push_back('?');
+        }
+    }
+}
+
+std::string utf8_to_cp1251(StringRef text)
+{
+    std::string result;
+
+    utf8_to_cp1251(text.data(), text.length(), result);
+
+    return result;
+}
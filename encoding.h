@@ -0,0 +1,39 @@
+#ifndef ENCODING_H
+#define ENCODING_H
+
+#include <string>
+
+#include "stringref.h"
+
+// Encodings a project file can come in. Project files saved by Code Composer
+// on Russian Windows are CP1251; everything is held as UTF-8 once read.
+
+enum class TextEncoding
+{
+    ASCII,
+    UTF8,
+    CP1251,
+};
+
+//// Detection =================================================================
+
+bool         is_ascii(const char* data, size_t size);
+bool         is_utf8(const char* data, size_t size);
+
+bool         has_utf8_bom(const char* data, size_t size);
+
+TextEncoding detect_encoding(const char* data, size_t size);
+
+const char*  encoding_name(TextEncoding encoding);
+
+//// Transcoding ===============================================================
+
+void         cp1251_to_utf8(const char* data, size_t size, std::string& out);
+std::string  cp1251_to_utf8(StringRef text);
+
+// Characters CP1251 has no byte for become '?'
+
+void         utf8_to_cp1251(const char* data, size_t size, std::string& out);
+std::string  utf8_to_cp1251(StringRef text);
+
+#endif // ENCODING_H
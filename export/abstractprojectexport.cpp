@@ -1,8 +1,11 @@
 #include "abstractprojectexport.h"
 
+#include <errno.h>
 #include <string.h>
 #include <iostream>
+#include <sstream>
 
+#include "../encoding.h"
 #include "../utils.h"
 
 AbstractProjectExport::AbstractProjectExport()
@@ -16,8 +19,46 @@ AbstractProjectExport::~AbstractProjectExport()
 
 bool AbstractProjectExport::write(const ProjectSettings &settings, const char *path)
 {
-    std::ostream* out = &std::cout;
+    std::string text;
 
+    if (not render(settings, text, path))
+    {
+        return false;
+    }
+
+    return writeText(text);
+}
+
+bool AbstractProjectExport::render(const ProjectSettings &settings, std::string &text, const char *path)
+{
+    if (path != nullptr)
+    {
+        mPath = path;
+    }
+
+    mLastError.clear();
+
+    std::ostringstream out;
+
+    bool res = writeData(settings, out);
+
+    // Text is held as UTF-8; file names, defines and commands of a project
+    // read as CP1251 must come out as the bytes it had
+
+    if (settings.encoding() == TextEncoding::CP1251 && not isBinary())
+    {
+        text = utf8_to_cp1251(out.str());
+    }
+    else
+    {
+        text = out.str();
+    }
+
+    return res;
+}
+
+bool AbstractProjectExport::writeText(const std::string &text, const char *path)
+{
     if (path != nullptr)
     {
         mPath = path;
@@ -25,33 +66,65 @@ bool AbstractProjectExport::write(const ProjectSettings &settings, const char *p
 
     mLastError.clear();
 
-    //// Open project file =====================================================
+    if (mPath.empty())
+    {
+        std::cout << text;
+        return true;
+    }
+
+    //// Skip unchanged project file ===========================================
 
-    std::ofstream projectFile;
+    // Read back in the mode written
+
+    std::ios::openmode mode = isBinary() ? std::ios::binary : (std::ios::openmode)0;
 
-    if (not mPath.empty())
     {
-        projectFile.open(mPath.c_str());
-        if (not projectFile.is_open())
+        std::ifstream currentFile(mPath.c_str(), std::ios::in | mode);
+
+        if (currentFile.is_open())
         {
-            mLastError = string_format("Failed to open project '%s': '%s'", mPath.c_str(), strerror(errno));
-            return false;
-        }
+            std::ostringstream current;
+            current << currentFile.rdbuf();
 
-        out = &projectFile;
+            if (current.str() == text)
+            {
+                return true;
+            }
+        }
     }
 
-    //// Write project =========================================================
+    //// Write project file ====================================================
 
-    bool res = writeData(settings, *out);
+    std::ofstream projectFile(mPath.c_str(), std::ios::out | mode);
+    if (not projectFile.is_open())
+    {
+        mLastError = string_format("Failed to open project '%s': '%s'", mPath.c_str(), strerror(errno));
+        return false;
+    }
 
-    //// Close project file ====================================================
+    projectFile << text;
 
     projectFile.close();
 
-    //// =======================================================================
+    if (projectFile.fail())
+    {
+        mLastError = string_format("Failed to write project '%s'", mPath.c_str());
+        return false;
+    }
+
+    return true;
+}
 
-    return res;
+bool AbstractProjectExport::cacheKey(uint64_t &key) const
+{
+    (void)key;
+
+    return true;
+}
+
+bool AbstractProjectExport::isBinary() const
+{
+    return false;
 }
 
 std::string AbstractProjectExport::lastError() const
@@ -1,6 +1,7 @@
 #ifndef ABSTRACTPROJECTEXPORT_H
 #define ABSTRACTPROJECTEXPORT_H
 
+#include <stdint.h>
 #include <string>
 #include <fstream>
 
@@ -14,6 +15,20 @@ public:
 
     bool write(const ProjectSettings& settings, const char* path = nullptr);
 
+    bool render(const ProjectSettings& settings, std::string& text, const char* path = nullptr);
+
+    // An existing file with the same text is left untouched, so make sees
+    // no change
+
+    bool writeText(const std::string& text, const char* path = nullptr);
+
+    // Mixes exporter options into an output cache key. False when the
+    // output also depends on files other than the project.
+
+    virtual bool cacheKey(uint64_t& key) const;
+
+    virtual bool isBinary() const;
+
     std::string lastError() const;
     std::string getPath() const;
 
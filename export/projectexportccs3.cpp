@@ -65,14 +65,14 @@ bool ProjectExportCcs3::writeData(const ProjectSettings &settings, std::ostream
     {
         out << "[\"" << configName << "\" Settings]" << std::endl;
 
-        ConfigSettings config = settings.configSettings(configName);
+        const ConfigSettings& config = settings.c_configSettings(configName);
 
-        for (const BuildStep& step : config.preBuildSteps())
+        for (const BuildStep& step : config.c_preBuildSteps())
         {
             writeConfig(out, "InitialBuildCmd", step.toString(), false);
         }
 
-        for (const BuildStep& step : config.postBuildSteps())
+        for (const BuildStep& step : config.c_postBuildSteps())
         {
             writeConfig(out, "FinalBuildCmd", step.toString(), false);
         }
@@ -86,23 +86,23 @@ bool ProjectExportCcs3::writeData(const ProjectSettings &settings, std::ostream
     {
         for (const std::string& configName : settings.configs())
         {
-            ConfigSettings config = settings.configSettings(configName);
+            const ConfigSettings& config = settings.c_configSettings(configName);
 
             out << "[\"Compiler\" Settings: \"" << configName << "\"]" << std::endl;
 
-            std::list<std::string> options = config.otherCompilerOptions();
+            stringlist options = config.c_otherCompilerOptions();
 
-            for (const std::string& include : config.includePaths())
+            for (const std::string& include : config.c_includePaths())
             {
                 options.push_back(to_option("-i", include));
             }
 
-            for (const std::string& define : config.defines())
+            for (const std::string& define : config.c_defines())
             {
                 options.push_back(to_option("-d", define));
             }
 
-            for (const std::string& undefine : config.undefines())
+            for (const std::string& undefine : config.c_undefines())
             {
                 options.push_back("-u\"" + undefine + "\"");
             }
@@ -119,11 +119,11 @@ bool ProjectExportCcs3::writeData(const ProjectSettings &settings, std::ostream
     {
         for (const std::string& configName : settings.configs())
         {
-            ConfigSettings config = settings.configSettings(configName);
+            const ConfigSettings& config = settings.c_configSettings(configName);
 
             out << "[\"Linker\" Settings: \"" << configName << "\"]" << std::endl;
 
-            std::list<std::string> options = config.otherLinkerOptions();
+            stringlist options = config.c_otherLinkerOptions();
 
             if (not config.mapFile().empty())
             {
@@ -135,12 +135,12 @@ bool ProjectExportCcs3::writeData(const ProjectSettings &settings, std::ostream
                 options.push_back(to_option("-o", config.outputFile()));
             }
 
-            for (const std::string& libraryPath : config.libraryPaths())
+            for (const std::string& libraryPath : config.c_libraryPaths())
             {
                 options.push_back(to_option("-i", libraryPath));
             }
 
-            for (const std::string& lib : config.libraries())
+            for (const std::string& lib : config.c_libraries())
             {
                 options.push_back(to_option("-l", lib));
             }
@@ -157,11 +157,11 @@ bool ProjectExportCcs3::writeData(const ProjectSettings &settings, std::ostream
     {
         for (const std::string& configName : settings.configs())
         {
-            ConfigSettings config = settings.configSettings(configName);
+            const ConfigSettings& config = settings.c_configSettings(configName);
 
             out << "[\"Archiver\" Settings: \"" << configName << "\"]" << std::endl;
 
-            writeConfig(out, "Options", join(config.otherArchiverOptions(), ' '), false);
+            writeConfig(out, "Options", join(config.c_otherArchiverOptions(), ' '), false);
 
             out << std::endl;
         }
@@ -169,33 +169,51 @@ bool ProjectExportCcs3::writeData(const ProjectSettings &settings, std::ostream
 
     //// File custom options ===================================================
 
+    std::vector< std::pair<std::string, unsigned int> > files;
+
+    for (const std::string& source : settings.files())
+    {
+        files.push_back(std::make_pair(source, settings.fileId(source)));
+    }
+
     for (const std::string& configName : settings.configs())
     {
-        for (const std::string& source : settings.files())
+        const ConfigSettings& config = settings.c_configSettings(configName);
+
+        for (const auto& file : files)
         {
-            FileOptions option = settings.configSettings(configName).fileOptions(source);
+            const std::string& source = file.first;
+            const FileOptions& option = config.c_fileOptions(file.second);
             if (not option.isDefault())
             {
                 out << "[\"" << source << "\" Settings: \"" << configName << "\"]" << std::endl;
 
                 //// Compiler options ------------------------------------------
 
-                stringset added   = option.optionsAdded();
-                stringset removed = option.optionsRemoved();
+                const internedset& added   = option.c_optionsAdded();
+                const internedset& removed = option.c_optionsRemoved();
 
                 if (not added.empty() || not removed.empty())
                 {
-                    std::list<std::string> compilerOptions;
+                    stringlist compilerOptions;
                     compilerOptions.push_back("\"Compiler\"");
 
                     if (not added.empty())
                     {
-                        compilerOptions.push_back("+{" + join(added, ' ') + "}");
+                        std::string list("+{");
+                        join_to(list, added, ' ');
+                        list.push_back('}');
+
+                        compilerOptions.push_back(std::move(list));
                     }
 
                     if (not removed.empty())
                     {
-                        compilerOptions.push_back("-{" + join(removed, ' ') + "}");
+                        std::string list("-{");
+                        join_to(list, removed, ' ');
+                        list.push_back('}');
+
+                        compilerOptions.push_back(std::move(list));
                     }
 
                     writeConfig(out, "Options", join(compilerOptions, ' '), false);
@@ -226,12 +244,12 @@ bool ProjectExportCcs3::writeData(const ProjectSettings &settings, std::ostream
 
                 //// Build commands --------------------------------------------
 
-                for (const BuildStep& step : option.preBuildSteps().get())
+                for (const BuildStep& step : option.c_preBuildSteps().c_get())
                 {
                     writeConfig(out, "PreBuildCmd", step.toString(), false);
                 }
 
-                for (const BuildStep& step : option.postBuildSteps().get())
+                for (const BuildStep& step : option.c_postBuildSteps().c_get())
                 {
                     writeConfig(out, "PostBuildCmd", step.toString(), false);
                 }
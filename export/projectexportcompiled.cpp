@@ -0,0 +1,24 @@
+#include "projectexportcompiled.h"
+
+#include "../compiledproject.h"
+
+ProjectExportCompiled::ProjectExportCompiled() : AbstractProjectExport ()
+{
+
+}
+
+bool ProjectExportCompiled::isBinary() const
+{
+    return true;
+}
+
+bool ProjectExportCompiled::writeData(const ProjectSettings &settings, std::ostream &out)
+{
+    std::string image;
+
+    CompiledProject::build(settings, image);
+
+    out.write(image.data(), (std::streamsize)image.size());
+
+    return true;
+}
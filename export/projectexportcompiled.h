@@ -0,0 +1,17 @@
+#ifndef PROJECTEXPORTCOMPILED_H
+#define PROJECTEXPORTCOMPILED_H
+
+#include "abstractprojectexport.h"
+
+class ProjectExportCompiled : public AbstractProjectExport
+{
+public:
+    ProjectExportCompiled();
+
+    bool isBinary() const override;
+
+private:
+    virtual bool writeData(const ProjectSettings& settings, std::ostream& out);
+};
+
+#endif // PROJECTEXPORTCOMPILED_H
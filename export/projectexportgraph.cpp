@@ -0,0 +1,263 @@
+#include "projectexportgraph.h"
+
+#include <map>
+
+#include "../utils.h"
+
+static std::string dot_string(const std::string& str)
+{
+    std::string result = "\"";
+
+    for (char c : str)
+    {
+        if (c == '"')
+        {
+            result.push_back('\\');
+        }
+
+        result.push_back(c);
+    }
+
+    result.push_back('"');
+
+    return result;
+}
+
+ProjectExportGraph::ProjectExportGraph()
+{
+
+}
+
+void ProjectExportGraph::setBuildTimes(const std::string& path)
+{
+    mBuildTimes.load(path);
+}
+
+void ProjectExportGraph::setSourceDir(const std::string& sourceDir)
+{
+    mSourceDir = sourceDir;
+}
+
+bool ProjectExportGraph::writeData(const ProjectSettings& settings, std::ostream& out)
+{
+    mGraph.build(settings, mBuildTimes, mSourceDir);
+
+    writeGraph(out);
+
+    return true;
+}
+
+bool ProjectExportGraph::cacheKey(uint64_t& key) const
+{
+    // Durations are estimated from source sizes on disk
+
+    (void)key;
+
+    return false;
+}
+
+//// ===========================================================================
+//// Report ====================================================================
+//// ===========================================================================
+
+ProjectExportGraphReport::ProjectExportGraphReport()
+{
+
+}
+
+void ProjectExportGraphReport::writeGraph(std::ostream& out)
+{
+    const std::vector<BuildGraph::Node>& nodes = mGraph.nodes();
+    std::string units = mGraph.units();
+
+    double work     = mGraph.totalWork();
+    double critical = mGraph.criticalPathLength();
+
+    out << string_format("Total work:          %.0f %s", work, units.c_str()) << std::endl;
+    out << string_format("Critical path:       %.0f %s", critical, units.c_str()) << std::endl;
+    out << string_format("Average parallelism: %.2f", critical > 0.0 ? work / critical : 0.0) << std::endl;
+    out << string_format("Max useful jobs:     %u", (unsigned int)mGraph.maxParallelism()) << std::endl;
+    out << std::endl;
+
+    //// Work per configuration ================================================
+
+    std::map<std::string, double> configWork;
+
+    for (const BuildGraph::Node& node : nodes)
+    {
+        if (not node.config.empty())
+        {
+            configWork[node.config] += node.weight;
+        }
+    }
+
+    out << "Work per configuration:" << std::endl;
+
+    for (const auto& config : configWork)
+    {
+        out << string_format("  %-20s %12.0f %s", config.first.c_str(), config.second, units.c_str()) << std::endl;
+    }
+
+    out << std::endl;
+
+    //// Critical path =========================================================
+
+    out << "Critical path:" << std::endl;
+
+    for (size_t index : mGraph.criticalPath())
+    {
+        const BuildGraph::Node& node = nodes.at(index);
+
+        out << string_format("  %12.0f %12.0f  %-10s %s%s",
+                             node.start,
+                             node.finish,
+                             BuildGraph::nodeTypeString(node.type).c_str(),
+                             node.name.c_str(),
+                             node.serial ? "  (serializes the build)" : "") << std::endl;
+    }
+}
+
+//// ===========================================================================
+//// DOT =======================================================================
+//// ===========================================================================
+
+ProjectExportGraphDot::ProjectExportGraphDot()
+{
+
+}
+
+void ProjectExportGraphDot::writeGraph(std::ostream& out)
+{
+    const std::vector<BuildGraph::Node>& nodes = mGraph.nodes();
+
+    out << "digraph build {" << std::endl;
+    out << "    rankdir=LR;" << std::endl;
+    out << "    node [shape=box];" << std::endl;
+
+    //// Nodes grouped by configuration ========================================
+
+    std::map<std::string, std::vector<size_t> > configNodes;
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        configNodes[nodes.at(i).config].push_back(i);
+    }
+
+    for (const auto& config : configNodes)
+    {
+        std::string indent = "    ";
+
+        if (not config.first.empty())
+        {
+            out << "    subgraph " << dot_string("cluster_" + config.first) << " {" << std::endl;
+            out << "        label=" << dot_string(config.first) << ";" << std::endl;
+            indent = "        ";
+        }
+
+        for (size_t index : config.second)
+        {
+            const BuildGraph::Node& node = nodes.at(index);
+
+            out << indent << "n" << index
+                << " [label=" << dot_string(string_format("%s\\n%.0f %s", node.name.c_str(), node.weight, mGraph.units().c_str()))
+                << (node.critical ? ", color=red, penwidth=2" : "")
+                << "];" << std::endl;
+        }
+
+        if (not config.first.empty())
+        {
+            out << "    }" << std::endl;
+        }
+    }
+
+    //// Dependencies ==========================================================
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        for (size_t dependency : nodes.at(i).dependencies)
+        {
+            out << "    n" << dependency << " -> n" << i;
+
+            if (nodes.at(i).critical && nodes.at(dependency).critical)
+            {
+                out << " [color=red]";
+            }
+
+            out << ";" << std::endl;
+        }
+    }
+
+    out << "}" << std::endl;
+}
+
+//// ===========================================================================
+//// JSON ======================================================================
+//// ===========================================================================
+
+ProjectExportGraphJson::ProjectExportGraphJson()
+{
+
+}
+
+void ProjectExportGraphJson::writeGraph(std::ostream& out)
+{
+    const std::vector<BuildGraph::Node>& nodes = mGraph.nodes();
+
+    out << "{" << std::endl;
+    out << "  \"units\": " << to_json_string(mGraph.units()) << "," << std::endl;
+    out << string_format("  \"totalWork\": %.0f,", mGraph.totalWork()) << std::endl;
+    out << string_format("  \"criticalPathLength\": %.0f,", mGraph.criticalPathLength()) << std::endl;
+    out << string_format("  \"maxParallelism\": %u,", (unsigned int)mGraph.maxParallelism()) << std::endl;
+
+    //// Nodes =================================================================
+
+    out << "  \"nodes\": [" << std::endl;
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const BuildGraph::Node& node = nodes.at(i);
+
+        out << string_format("    {\"id\": %u, \"name\": %s, \"config\": %s, \"type\": %s, "
+                             "\"weight\": %.0f, \"start\": %.0f, \"finish\": %.0f, "
+                             "\"critical\": %s, \"serial\": %s}",
+                             (unsigned int)i,
+                             to_json_string(node.name).c_str(),
+                             to_json_string(node.config).c_str(),
+                             to_json_string(BuildGraph::nodeTypeString(node.type)).c_str(),
+                             node.weight,
+                             node.start,
+                             node.finish,
+                             node.critical ? "true" : "false",
+                             node.serial ? "true" : "false");
+
+        out << (i + 1 < nodes.size() ? "," : "") << std::endl;
+    }
+
+    out << "  ]," << std::endl;
+
+    //// Edges =================================================================
+
+    stringlist edges;
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        for (size_t dependency : nodes.at(i).dependencies)
+        {
+            edges.push_back(string_format("[%u, %u]", (unsigned int)dependency, (unsigned int)i));
+        }
+    }
+
+    out << "  \"edges\": [" << join(edges, ',') << "]," << std::endl;
+
+    //// Critical path =========================================================
+
+    stringlist path;
+
+    for (size_t index : mGraph.criticalPath())
+    {
+        path.push_back(string_format("%u", (unsigned int)index));
+    }
+
+    out << "  \"criticalPath\": [" << join(path, ',') << "]" << std::endl;
+    out << "}" << std::endl;
+}
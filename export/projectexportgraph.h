@@ -0,0 +1,58 @@
+#ifndef PROJECTEXPORTGRAPH_H
+#define PROJECTEXPORTGRAPH_H
+
+#include "abstractprojectexport.h"
+#include "../buildgraph.h"
+
+class ProjectExportGraph : public AbstractProjectExport
+{
+public:
+    ProjectExportGraph();
+
+    void setBuildTimes(const std::string& path);
+    void setSourceDir(const std::string& sourceDir);
+
+protected:
+
+    BuildGraph  mGraph;
+
+    bool writeData(const ProjectSettings& settings, std::ostream& out) override;
+
+    bool cacheKey(uint64_t& key) const override;
+
+    virtual void writeGraph(std::ostream& out) = 0;
+
+private:
+
+    BuildTimes  mBuildTimes;
+    std::string mSourceDir;
+};
+
+class ProjectExportGraphReport : public ProjectExportGraph
+{
+public:
+    explicit ProjectExportGraphReport();
+
+private:
+    void writeGraph(std::ostream& out) override;
+};
+
+class ProjectExportGraphDot : public ProjectExportGraph
+{
+public:
+    explicit ProjectExportGraphDot();
+
+private:
+    void writeGraph(std::ostream& out) override;
+};
+
+class ProjectExportGraphJson : public ProjectExportGraph
+{
+public:
+    explicit ProjectExportGraphJson();
+
+private:
+    void writeGraph(std::ostream& out) override;
+};
+
+#endif // PROJECTEXPORTGRAPH_H
@@ -1,10 +1,15 @@
 #include "projectexportmakefile.h"
 
 #include <string.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
+#include "optionset.h"
 #include "utils.h"
+#include "variablestring.h"
 
-ProjectExportMakefile::ProjectExportMakefile() : mTabWidth(4)
+ProjectExportMakefile::ProjectExportMakefile() : mTabWidth(4), mResponseFiles(false)
 {
 
 }
@@ -13,11 +18,10 @@ void ProjectExportMakefile::setTarget(std::string target)
 {
     target = basename(target);
 
-    stringlist namelist = split(target, '.');
-    if (namelist.size() > 1)
+    std::size_t pos = target.rfind('.');
+    if (pos != std::string::npos)
     {
-        namelist.pop_back();
-        target = join(namelist, '.');
+        target.erase(pos);
     }
 
     mTarget = target;
@@ -28,98 +32,108 @@ void ProjectExportMakefile::setTabWidth(size_t tabWidth)
     mTabWidth = tabWidth;
 }
 
-std::string getObjectName(const std::string& source)
+void ProjectExportMakefile::setResponseFiles(bool responseFiles)
 {
-    stringlist pathlist = split(source, '/');
+    mResponseFiles = responseFiles;
+}
+
+void ProjectExportMakefile::setBuildTimes(const std::string& path)
+{
+    // The Makefile appends to the file from its own directory, the history
+    // is only shared if both name it absolutely
+
+    mBuildTimesPath = absolute_path(path);
 
-    if (pathlist.size() > 0)
+    if (mBuildTimes.load(path) && not mBuildTimes.compacted())
     {
-        std::string name = pathlist.back();
-        stringlist namelist = split(name, '.');
+        mBuildTimes.save(path);
+    }
+}
 
-        if (namelist.size() > 1)
-        {
-            namelist.pop_back();
-            namelist.push_back("obj");
-        }
+void ProjectExportMakefile::setSourceDir(const std::string& sourceDir)
+{
+    mSourceDir = sourceDir;
+}
+
+void ProjectExportMakefile::setTraceDir(const std::string& traceDir)
+{
+    mTraceDir = traceDir;
+}
 
-        return join(namelist, '.');
+bool ProjectExportMakefile::cacheKey(uint64_t& key) const
+{
+    key = hash_string(mTarget, key);
+    key = hash_combine(key, (uint64_t)mTabWidth);
+    key = hash_combine(key, mResponseFiles ? 1 : 0);
+    key = hash_string(mSourceDir, key);
+    key = hash_string(mTraceDir, key);
+
+    // Build order follows recorded times and source sizes on disk
+
+    return mBuildTimesPath.empty();
+}
+
+std::string ProjectExportMakefile::record(const std::string& command, const char* kind, const std::string& config, const std::string& key) const
+{
+    if (mBuildTimesPath.empty() && mTraceDir.empty())
+    {
+        return command;
+    }
+
+    std::string arguments = std::string(kind) + "," + config;
+
+    if (not key.empty())
+    {
+        arguments += "," + key;
     }
 
-    return source;
+    return "$(RECORD_BEGIN) " + command + " $(call RECORD_END," + arguments + ")";
 }
 
-stringlist getObjects(const stringset& sources)
+static const char* const ARCHIVER_COMMANDS[] =
+{
+    "-a",
+    "-d",
+    "-r",
+    "-t",
+    "-x"
+};
+
+stringlist getObjects(const ProjectSettings& settings, const stringset& sources)
 {
     stringlist objects;
+    objects.reserve(sources.size());
 
     for (const std::string& source : sources)
     {
-        objects.push_back(getObjectName(source));
+        objects.push_back(settings.filePath(settings.fileId(source)).objectName());
     }
 
     return objects;
 }
 
-std::string fixVariables(std::string s)
+std::string fixVariables(const std::string& s)
 {
-    int type = 0;
+    return VariableString::render(s, VariableString::Dialect::MAKE);
+}
 
-    for (size_t i = 0; i < s.size(); ++i)
-    {
-        if (s[i] == '%')
-        {
-            if (type == 0)
-            {
-                s[i] = '$';
-                s.insert(i + 1, "(");
-            }
-            else
-            {
-                s[i] = ')';
-            }
+stringlist fixVariables(const stringlist& list)
+{
+    stringlist result;
 
-            type ^= 1;
-        }
-        else if (s[i] == '\\')
-        {
-            s[i] = '/';
-        }
+    for (const std::string& s : list)
+    {
+        result.push_back(fixVariables(s));
     }
 
-    return s;
+    return result;
 }
 
 void addVariables(stringset& variables, const stringlist& options)
 {
     for (const std::string& option : options)
     {
-        std::string variable;
-        bool inVariable = false;
-
-        for (char c : option)
-        {
-            if (c != '%')
-            {
-                if (inVariable)
-                {
-                    variable.append(&c, 1);
-                }
-            }
-            else
-            {
-                if (inVariable)
-                {
-                    variables.insert(variable);
-                }
-                else
-                {
-                    variable.clear();
-                }
-
-                inVariable = !inVariable;
-            }
-        }
+        VariableString::variables(option, variables);
     }
 }
 
@@ -147,6 +161,84 @@ void removeOption(stringlist& optionsList, const std::string& option, bool flag
     optionsList = result;
 }
 
+// Flags for each value of a Makefile list. Make splits lists at blanks, so a
+// list holding a value with one gets its flags written out quoted instead
+
+std::string listFlags(const std::string& flag, const std::string& list, const stringlist& values)
+{
+    bool blanks = false;
+
+    for (const std::string& value : values)
+    {
+        if (value.find_first_of(" \t") != std::string::npos)
+        {
+            blanks = true;
+            break;
+        }
+    }
+
+    if (not blanks)
+    {
+        return "$(addsuffix \",$(addprefix " + flag + "\",$(" + list + ")))";
+    }
+
+    stringlist flags;
+
+    for (const std::string& value : values)
+    {
+        flags.push_back(flag + "\"" + value + "\"");
+    }
+
+    return join(flags, ' ');
+}
+
+static bool longerJob(const std::pair<double, std::string>& a, const std::pair<double, std::string>& b)
+{
+    return a.first > b.first;
+}
+
+stringlist ProjectExportMakefile::orderObjects(const stringlist& objects,
+                                               const std::map<std::string, std::string>& objectSources,
+                                               const std::string& objectDir) const
+{
+    std::map<std::string, unsigned long> sizes;
+
+    for (const std::string& object : objects)
+    {
+        sizes[objectDir + "/" + object] = file_size(sourcePath(objectSources.at(object)));
+    }
+
+    std::map<std::string, double> durations = mBuildTimes.estimate(sizes);
+
+    std::vector<std::pair<double, std::string> > costs;
+
+    for (const std::string& object : objects)
+    {
+        costs.push_back(std::make_pair(durations.at(objectDir + "/" + object), object));
+    }
+
+    std::stable_sort(costs.begin(), costs.end(), longerJob);
+
+    stringlist result;
+
+    for (const auto& cost : costs)
+    {
+        result.push_back(cost.second);
+    }
+
+    return result;
+}
+
+std::string ProjectExportMakefile::sourcePath(const std::string& source) const
+{
+    if (mSourceDir.empty())
+    {
+        return source;
+    }
+
+    return mSourceDir + "/" + source;
+}
+
 bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostream& out)
 {
     writeConfig(out, "TARGET", mTarget);
@@ -173,19 +265,64 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
 
     out << std::endl;
 
+    //// Build recorder ========================================================
+
+    if (not mBuildTimesPath.empty() || not mTraceDir.empty())
+    {
+        // date without %N support (BSD, busybox) prints a literal N, times
+        // are kept in nanoseconds of whole seconds then
+
+        writeConfig(out, "NANOSECONDS", "$(if $(findstring N,$(shell date +%N)),000000000,%N)");
+
+        std::string recordEnd = "; status=$$?; end=$$(date +%s$(NANOSECONDS));";
+
+        if (not mBuildTimesPath.empty())
+        {
+            writeConfig(out, "BUILD_TIMES", mBuildTimesPath);
+
+            recordEnd += " echo \"$$(( (end - start) / 1000000 )) $(if $(3),$(3),$@)\" >> \"$(BUILD_TIMES)\";";
+        }
+
+        if (not mTraceDir.empty())
+        {
+            writeConfig(out, "TRACE_DIR", mTraceDir);
+            writeConfig(out, "TRACE_LOG", "$(shell mkdir -p \"$(TRACE_DIR)\" && echo \"$(TRACE_DIR)/build-$$(date +%s$(NANOSECONDS)).trace\")");
+
+            recordEnd += " echo \"$$start $$end $$$$ $(1) $(2) $(if $(3),$(3),$@)\" >> \"$(TRACE_LOG)\";";
+        }
+
+        recordEnd += " exit $$status";
+
+        out << std::endl;
+
+        writeConfig(out, "RECORD_BEGIN", "start=$$(date +%s$(NANOSECONDS));", false);
+        writeConfig(out, "RECORD_END", recordEnd, false);
+
+        out << std::endl;
+    }
+
+    bool archive = (settings.projectType() == ProjectSettings::Type::LIBRARY &&
+                    (tools & ProjectSettings::TOOL_ARCHIVER));
+
     //// Sources paths and objects names =======================================
 
-    stringset sources = settings.sources();
-    stringlist objects = getObjects(sources);
+    cstringset& sources = settings.c_sources();
+    stringlist objects = getObjects(settings, sources);
 
-    std::map<std::string, std::string> objectSources;
+    std::map<std::string, std::string>  objectSources;
+    std::map<std::string, unsigned int> objectFileIds;
 
     for (const std::string& source : sources)
     {
-        std::string object = getObjectName(source);
+        unsigned int fileId = settings.fileId(source);
+
+        const std::string& object = settings.filePath(fileId).objectName();
         objectSources[object] = source;
+        objectFileIds[object] = fileId;
     }
 
+    OptionDictionary dictionary(settings);
+
     writeConfig(out, "SOURCES", fixVariables(join(sources, ' ')));
     writeConfig(out, "OBJECTS", join(objects, ' '));
     out << std::endl;
@@ -229,6 +366,12 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
     out << "\t" << "rm -rf " << join(settings.configs(), ' ') << std::endl;
     out << std::endl;
 
+    if (mResponseFiles)
+    {
+        out << "FORCE:" << std::endl;
+        out << std::endl;
+    }
+
     //// Configurations ========================================================
 
     for (const std::string& configName : settings.configs())
@@ -236,7 +379,7 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
         std::string config_l = to_lower(configName);
         std::string config_u = to_upper(configName);
 
-        const ConfigSettings config = settings.configSettings(configName);
+        const ConfigSettings& config = settings.c_configSettings(configName);
 
         writeComment(out, 1, configName);
 
@@ -248,22 +391,36 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
 
         std::string objectPaths = "$(addprefix " + configName + "/,$(OBJECTS))";
 
-        writeConfig(out, "OBJECTS_", to_upper(configName), objectPaths);
+        stringlist configObjects = objects;
+
+        if (not mBuildTimesPath.empty())
+        {
+            configObjects = orderObjects(objects, objectSources, configName);
+
+            writeConfig(out, "OBJECTS_", to_upper(configName), "$(addprefix " + configName + "/," + join(configObjects, ' ') + ")");
+            writeConfig(out, "LINK_OBJECTS_", to_upper(configName), objectPaths);
+        }
+        else
+        {
+            writeConfig(out, "OBJECTS_", to_upper(configName), objectPaths);
+        }
 
         out << std::endl;
 
+        std::string linkObjects = (mBuildTimesPath.empty() ? "OBJECTS_" : "LINK_OBJECTS_") + config_u;
+
         //// Compiler options --------------------------------------------------
 
         if (tools & ProjectSettings::TOOL_COMPILER)
         {
             writeComment(out, 3, "Compiler options");
 
-            writeConfig(out, "INCLUDES_", config_u, fixVariables(join(config.includePaths(), ' ')));
-            writeConfig(out, "DEFINES_", config_u, join(config.defines(), ' '));
+            writeConfig(out, "INCLUDES_", config_u, fixVariables(join(config.c_includePaths(), ' ')));
+            writeConfig(out, "DEFINES_", config_u, join(config.c_defines(), ' '));
             out << std::endl;
 
-            std::string iflags = "$(addsuffix \",$(addprefix -i\",$(INCLUDES_" + config_u + ")))";
-            std::string dflags = "$(addsuffix \",$(addprefix -d\",$(DEFINES_" + config_u + ")))";
+            std::string iflags = listFlags("-i", "INCLUDES_" + config_u, fixVariables(config.c_includePaths()));
+            std::string dflags = listFlags("-d", "DEFINES_" + config_u, config.c_defines());
 
             writeConfig(out, "IFLAGS_", config_u, iflags);
             writeConfig(out, "DFLAGS_", config_u, dflags);
@@ -276,12 +433,12 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
         {
             writeComment(out, 3, "Linker options");
 
-            writeConfig(out, "MEM_", config_u,  fixVariables(join(settings.commands(), ' '))); //TODO: replace with ordered list
-            writeConfig(out, "ARCHIVES_", config_u, fixVariables(join(settings.libraries(), ' ')));
+            writeConfig(out, "MEM_", config_u,  fixVariables(join(settings.c_commands(), ' '))); //TODO: replace with ordered list
+            writeConfig(out, "ARCHIVES_", config_u, fixVariables(join(settings.c_libraries(), ' ')));
             out << std::endl;
 
-            bool haveLibPaths = not config.libraryPaths().empty();
-            bool haveLibs = not config.libraries().empty();
+            bool haveLibPaths = not config.c_libraryPaths().empty();
+            bool haveLibs = not config.c_libraries().empty();
             stringlist libflags;
 
             if (haveLibPaths)
@@ -289,9 +446,9 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
                 writeConfig(out,
                             "LIBS_PATHS_",
                             config_u,
-                            fixVariables(join(config.libraryPaths(), ' ')));
+                            fixVariables(join(config.c_libraryPaths(), ' ')));
 
-                libflags.push_back("$(addsuffix \",$(addprefix -i\",$(LIBS_PATHS_" + config_u + ")))");
+                libflags.push_back(listFlags("-i", "LIBS_PATHS_" + config_u, fixVariables(config.c_libraryPaths())));
             }
 
             if (haveLibs)
@@ -299,9 +456,9 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
                 writeConfig(out,
                             "LIBS_",
                             config_u,
-                            fixVariables(join(config.libraries(), ' ')));
+                            fixVariables(join(config.c_libraries(), ' ')));
 
-                libflags.push_back("$(addsuffix \",$(addprefix -l\",$(LIBS_" + config_u + ")))");
+                libflags.push_back(listFlags("-l", "LIBS_" + config_u, fixVariables(config.c_libraries())));
             }
 
             if (haveLibs || haveLibPaths)
@@ -334,7 +491,7 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
             writeConfig(out, "OUT_", config_u + "_DIR", "$(dir $(OUT_" + config_u + "))");
             out << std::endl;
 
-            stringlist linkerOptions = config.otherLinkerOptions();
+            stringlist linkerOptions = config.c_otherLinkerOptions();
             removeOption(linkerOptions, "-m", false);
             removeOption(linkerOptions, "-o", false);
 
@@ -356,22 +513,96 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
             out << config_l << ": $(OUT_" << config_u << ")" << std::endl;
             out << std::endl;
 
-            out << string_format("$(OUT_%s): $(MEM_%s) $(OBJDIR_%s)/pre_build $(OBJECTS_%s) $(ARCHIVES_%s)",
-                                 config_u.c_str(),
-                                 config_u.c_str(),
+            std::string linkerInput = string_format("$(LDFLAGS_%s) $(MEM_%s) $(%s) $(ARCHIVES_%s)",
+                                                    config_u.c_str(),
+                                                    config_u.c_str(),
+                                                    linkObjects.c_str(),
+                                                    config_u.c_str());
+
+            if (mResponseFiles)
+            {
+                writeResponseFile(out, "$(OBJDIR_" + config_u + ")/ldflags.opt", config_u, linkerInput);
+
+                out << string_format("$(OUT_%s): $(MEM_%s) $(OBJDIR_%s)/pre_build $(OBJECTS_%s) $(ARCHIVES_%s) $(OBJDIR_%s)/ldflags.opt",
+                                     config_u.c_str(),
+                                     config_u.c_str(),
+                                     config_u.c_str(),
+                                     config_u.c_str(),
+                                     config_u.c_str(),
+                                     config_u.c_str()) << std::endl;
+
+                out << "\t" << "mkdir -p $(OUT_" << config_u << "_DIR)" << std::endl;
+                out << "\t" << record("$(LD) -@$(OBJDIR_" + config_u + ")/ldflags.opt", "link", configName, configName + "/link") << std::endl;
+            }
+            else
+            {
+                out << string_format("$(OUT_%s): $(MEM_%s) $(OBJDIR_%s)/pre_build $(OBJECTS_%s) $(ARCHIVES_%s)",
+                                     config_u.c_str(),
+                                     config_u.c_str(),
+                                     config_u.c_str(),
+                                     config_u.c_str(),
+                                     config_u.c_str()) << std::endl;
+
+                out << "\t" << "mkdir -p $(OUT_" << config_u << "_DIR)" << std::endl;
+                out << "\t" << record("$(LD) " + linkerInput, "link", configName, configName + "/link") << std::endl;
+            }
+
+            out << std::endl;
+
+        }
+
+        //// Archiver options --------------------------------------------------
+
+        if (archive)
+        {
+            writeComment(out, 3, "Archiver options");
+
+            std::string library = config.archiverOption("-o");
+
+            if (not library.empty())
+            {
+                writeConfig(out, "LIB_", config_u, fixVariables(library));
+            }
+            else
+            {
+                writeConfig(out, "LIB_", config_u, "./$(OBJDIR_" + config_u + ")/$(TARGET).lib");
+            }
+
+            out << std::endl;
+
+            writeConfig(out, "LIB_", config_u + "_DIR", "$(dir $(LIB_" + config_u + "))");
+            out << std::endl;
+
+            stringlist archiverOptions = config.c_otherArchiverOptions();
+            removeOption(archiverOptions, "-o");
+
+            for (const char* command : ARCHIVER_COMMANDS)
+            {
+                removeOption(archiverOptions, command);
+            }
+
+            writeConfig(out, "ARFLAGS_", config_u, join(archiverOptions, ' '));
+            out << std::endl;
+
+            writeComment(out, 5, "Archive");
+
+            out << config_l << ": $(LIB_" << config_u << ")" << std::endl;
+            out << std::endl;
+
+            out << string_format("$(LIB_%s): $(OBJECTS_%s) | $(OBJDIR_%s)/pre_build",
                                  config_u.c_str(),
                                  config_u.c_str(),
                                  config_u.c_str()) << std::endl;
 
-            out << "\t" << "mkdir -p $(OUT_" << config_u << "_DIR)" << std::endl;
-            out << "\t" << string_format("$(LD) $(LDFLAGS_%s) $(MEM_%s) $(OBJECTS_%s) $(ARCHIVES_%s)",
-                                         config_u.c_str(),
-                                         config_u.c_str(),
-                                         config_u.c_str(),
-                                         config_u.c_str()) << std::endl;
+            out << "\t" << "mkdir -p $(LIB_" << config_u << "_DIR)" << std::endl;
+            out << "\t" << record(string_format("$(AR) r $(ARFLAGS_%s) $@ $(filter $(OBJECTS_%s),$?)",
+                                                config_u.c_str(),
+                                                config_u.c_str()),
+                                  "archive",
+                                  configName,
+                                  configName + "/archive") << std::endl;
 
             out << std::endl;
-
         }
 
         //// Prebuild ----------------------------------------------------------
@@ -388,9 +619,14 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
 
         out << "\t" << "mkdir -p $(OBJDIR_" << config_u << ")" << std::endl;
 
-        for (const BuildStep& prebuild : config.preBuildSteps()) //TODO: Add always build targets
+        unsigned int step = 0;
+
+        for (const BuildStep& prebuild : config.c_preBuildSteps()) //TODO: Add always build targets
         {
-            out << "\t" << fixVariables(cp1251_to_unicode(prebuild.command())) << std::endl;
+            out << "\t" << record(prebuild.commandTemplate().render(VariableString::Dialect::MAKE),
+                                  "pre_build",
+                                  configName,
+                                  string_format("%s/pre_build.%u", configName.c_str(), ++step)) << std::endl;
         }
 
         out << "\t" << "touch $@" << std::endl;
@@ -403,13 +639,19 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
         out << "post_" << config_l << ": $(OBJDIR_" << config_u << ")/post_build" << std::endl;
         out << std::endl;
 
-        out << string_format("$(OBJDIR_%s)/post_build: $(OUT_%s) $(MAKEFILE)",
+        out << string_format("$(OBJDIR_%s)/post_build: $(%s_%s) $(MAKEFILE)",
                              config_u.c_str(),
+                             archive ? "LIB" : "OUT",
                              config_u.c_str()) << std::endl;
 
-        for (const BuildStep& postbuild : config.postBuildSteps()) //TODO: Add always build targets
+        step = 0;
+
+        for (const BuildStep& postbuild : config.c_postBuildSteps()) //TODO: Add always build targets
         {
-            out << "\t" << fixVariables(cp1251_to_unicode(postbuild.command())) << std::endl;
+            out << "\t" << record(postbuild.commandTemplate().render(VariableString::Dialect::MAKE),
+                                  "post_build",
+                                  configName,
+                                  string_format("%s/post_build.%u", configName.c_str(), ++step)) << std::endl;
         }
 
         out << "\t" << "touch $@" << std::endl;
@@ -428,56 +670,101 @@ bool ProjectExportMakefile::writeData(const ProjectSettings& settings, std::ostr
             out << "\t" << "mkdir -p $@" << std::endl;
             out << std::endl;
 
-            for (const std::string& object : objects)
+            std::map<std::string, unsigned int> optionGroups;
+
+            //// Files with the same effective option sets share one string ---
+
+            OptionResolver resolver(config.c_otherCompilerOptions(), dictionary);
+
+            std::unordered_map<OptionResolver::Resolved, std::string, OptionResolver::ResolvedHash> resolvedOptions;
+
+            for (const std::string& object : configObjects)
             {
                 const std::string& source = objectSources.at(object);
-                FileOptions fileOptions = config.fileOptions(source);
+                const OptionResolver::Resolved& resolved = resolver.resolve(config.c_fileOptions(objectFileIds.at(object)));
 
-                stringlist compilerOptions = config.otherCompilerOptions();
+                auto known = resolvedOptions.find(resolved);
 
-                for (const std::string& optionRemove : fileOptions.optionsRemoved())
+                if (known == resolvedOptions.end())
                 {
-                    removeOption(compilerOptions, optionRemove);
+                    stringlist compilerOptions = resolver.options(resolved);
+
+                    removeOption(compilerOptions, "-fr", false);
+
+                    compilerOptions.push_back("-fr $(OBJDIR_" + config_u + ")");
+
+                    known = resolvedOptions.insert(std::make_pair(resolved, join(compilerOptions, ' '))).first;
                 }
 
-                for (const std::string& optionAdd : fileOptions.optionsAdded())
+                const std::string& options = known->second;
+
+                if (not mResponseFiles)
                 {
-                    compilerOptions.push_back(optionAdd);
+                    out << "$(OBJDIR_" << config_u << ")/" << object << ": " << source << " $(MAKEFILE)" << " | $(OBJDIR_" + config_u + ")/pre_build" << std::endl;
+                    out << "\t" << /*"cd $(dir " << source << ") && " <<*/ record("$(CC) " + options + " $(IFLAGS_" + config_u + ") $(DFLAGS_" + config_u + ") " + source, "compile", configName) << std::endl;
+                    out << std::endl;
+
+                    continue;
                 }
 
-                removeOption(compilerOptions, "-fr", false);
+                //// Objects with the same options share one option file -------
+
+                auto group = optionGroups.find(options);
+
+                if (group == optionGroups.end())
+                {
+                    group = optionGroups.insert(std::make_pair(options, (unsigned int)optionGroups.size() + 1)).first;
+
+                    std::string optionsName = string_format("%s_%u", config_u.c_str(), group->second);
+
+                    writeConfig(out, "CFLAGS_", optionsName, options + " $(IFLAGS_" + config_u + ") $(DFLAGS_" + config_u + ")");
+                    out << std::endl;
 
-                compilerOptions.push_back("-fr $(OBJDIR_" + config_u + ")");
+                    writeResponseFile(out,
+                                      string_format("$(OBJDIR_%s)/cflags_%u.opt", config_u.c_str(), group->second),
+                                      config_u,
+                                      "$(CFLAGS_" + optionsName + ")");
+                }
 
-                out << "$(OBJDIR_" << config_u << ")/" << object << ": " << source << " $(MAKEFILE)" << " | $(OBJDIR_" + config_u + ")/pre_build" << std::endl;
-                out << "\t" << /*"cd $(dir " << source << ") && " <<*/ "$(CC) " << join(compilerOptions, ' ') << " $(IFLAGS_" << config_u << ") $(DFLAGS_" << config_u << ") " << source << std::endl;
+                out << string_format("$(OBJDIR_%s)/%s: %s $(OBJDIR_%s)/cflags_%u.opt $(MAKEFILE) | $(OBJDIR_%s)/pre_build",
+                                     config_u.c_str(),
+                                     object.c_str(),
+                                     source.c_str(),
+                                     config_u.c_str(),
+                                     group->second,
+                                     config_u.c_str()) << std::endl;
+                out << "\t" << record(string_format("$(CC) -@$(OBJDIR_%s)/cflags_%u.opt %s",
+                                                    config_u.c_str(),
+                                                    group->second,
+                                                    source.c_str()),
+                                      "compile",
+                                      configName) << std::endl;
                 out << std::endl;
             }
         }
 
         //// Checks ------------------------------------------------------------
 
-        stringlist buildSteps;
-        for (const BuildStep& step : config.preBuildSteps()) //TODO: Add always build targets
+        std::set<std::string> variables;
+        addVariables(variables, config.c_includePaths());
+        addVariables(variables, config.c_defines());
+        addVariables(variables, config.c_undefines());
+        addVariables(variables, config.c_libraryPaths());
+        addVariables(variables, config.c_libraries());
+        addVariables(variables, config.c_otherCompilerOptions());
+        addVariables(variables, config.c_otherLinkerOptions());
+        addVariables(variables, config.c_otherArchiverOptions());
+
+        for (const BuildStep& step : config.c_preBuildSteps()) //TODO: Add always build targets
         {
-            buildSteps.push_back(step.command());
+            step.commandTemplate().variables(variables);
         }
-        for (const BuildStep& step : config.postBuildSteps()) //TODO: Add always build targets
+
+        for (const BuildStep& step : config.c_postBuildSteps()) //TODO: Add always build targets
         {
-            buildSteps.push_back(step.command());
+            step.commandTemplate().variables(variables);
         }
 
-        std::set<std::string> variables;
-        addVariables(variables, config.includePaths());
-        addVariables(variables, config.defines());
-        addVariables(variables, config.undefines());
-        addVariables(variables, config.libraryPaths());
-        addVariables(variables, config.libraries());
-        addVariables(variables, config.otherCompilerOptions());
-        addVariables(variables, config.otherLinkerOptions());
-        addVariables(variables, config.otherArchiverOptions());
-        addVariables(variables, buildSteps);
-
         writeComment(out, 2, "Checks");
 
         out << "check_" << config_l << ": check" << std::endl;
@@ -626,3 +913,14 @@ void ProjectExportMakefile::writeComment(std::ostream& out, size_t level, const
         out << std::endl;
     }
 }
+
+// Option files expand variables the environment may change, so they are
+// rewritten on every run but only replaced when their contents differ
+
+void ProjectExportMakefile::writeResponseFile(std::ostream &out, const std::string &path, const std::string &config_u, const std::string &contents)
+{
+    out << path << ": FORCE | $(OBJDIR_" << config_u << ")/pre_build" << std::endl;
+    out << "\t" << "$(file >$@.tmp," << contents << ")" << std::endl;
+    out << "\t" << "@cmp -s $@.tmp $@ && rm -f $@.tmp || mv -f $@.tmp $@" << std::endl;
+    out << std::endl;
+}
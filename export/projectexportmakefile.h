@@ -2,6 +2,7 @@
 #define PROJECTEXPORTMAKEFILE_H
 
 #include "abstractprojectexport.h"
+#include "../buildtimes.h"
 
 class ProjectExportMakefile : public AbstractProjectExport
 {
@@ -9,11 +10,31 @@ public:
     ProjectExportMakefile();
     void setTarget(std::string target);
     void setTabWidth(size_t tabWidth);
+    void setResponseFiles(bool responseFiles);
+    void setBuildTimes(const std::string& path);
+    void setSourceDir(const std::string& sourceDir);
+    void setTraceDir(const std::string& traceDir);
+
+    bool cacheKey(uint64_t& key) const override;
 
 private:
 
     std::string mTarget;
     size_t      mTabWidth;
+    bool        mResponseFiles;
+
+    std::string mBuildTimesPath;
+    BuildTimes  mBuildTimes;
+    std::string mSourceDir;
+    std::string mTraceDir;
+
+    stringlist orderObjects(const stringlist& objects,
+                            const std::map<std::string, std::string>& objectSources,
+                            const std::string& objectDir) const;
+
+    std::string sourcePath(const std::string& source) const;
+
+    std::string record(const std::string& command, const char* kind, const std::string& config, const std::string& key = std::string()) const;
 
     virtual bool writeData(const ProjectSettings& settings, std::ostream& out);
 
@@ -21,6 +42,8 @@ private:
     void writeConfig(std::ostream &out, const char* name, const std::string &nameSuffix, const std::string &value, bool constant = true);
 
     void writeComment(std::ostream &out, size_t level, const std::string &name, bool emptyLine = true);
+
+    void writeResponseFile(std::ostream &out, const std::string &path, const std::string &config_u, const std::string &contents);
 };
 
 #endif // PROJECTEXPORTMAKEFILE_H
@@ -1,5 +1,7 @@
 #include "projectexportqtmakefile.h"
 
+#include "../utils.h"
+
 ProjectExportQtMakefileSources::ProjectExportQtMakefileSources()
 {
 
@@ -23,14 +25,14 @@ ProjectExportQtMakefileDefines::ProjectExportQtMakefileDefines(const std::string
 
 bool ProjectExportQtMakefileDefines::writeData(const ProjectSettings& settings, std::ostream& file)
 {
-    const ConfigSettings& config = settings.configSettings(mConfig);
+    const ConfigSettings& config = settings.c_configSettings(mConfig);
 
-    for (std::string define : config.defines())
+    for (const std::string& define : config.c_defines())
     {
         file << "#define " << define << std::endl;
     }
 
-    for (std::string undefine : config.undefines())
+    for (const std::string& undefine : config.c_undefines())
     {
         file << "#undef " << undefine << std::endl;
     }
@@ -38,6 +40,13 @@ bool ProjectExportQtMakefileDefines::writeData(const ProjectSettings& settings,
     return true;
 }
 
+bool ProjectExportQtMakefileDefines::cacheKey(uint64_t& key) const
+{
+    key = hash_string(mConfig, key);
+
+    return true;
+}
+
 ProjectExportQtMakefileIncludes::ProjectExportQtMakefileIncludes(const std::string& config) :
     mConfig(config)
 {
@@ -46,12 +55,19 @@ ProjectExportQtMakefileIncludes::ProjectExportQtMakefileIncludes(const std::stri
 
 bool ProjectExportQtMakefileIncludes::writeData(const ProjectSettings& settings, std::ostream& file)
 {
-    const ConfigSettings& config = settings.configSettings(mConfig);
+    const ConfigSettings& config = settings.c_configSettings(mConfig);
 
-    for (std::string include : config.includePaths())
+    for (const std::string& include : config.c_includePaths())
     {
         file << include << std::endl;
     }
 
     return true;
 }
+
+bool ProjectExportQtMakefileIncludes::cacheKey(uint64_t& key) const
+{
+    key = hash_string(mConfig, key);
+
+    return true;
+}
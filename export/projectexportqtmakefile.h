@@ -22,6 +22,8 @@ public:
 
     bool writeData(const ProjectSettings& settings, std::ostream& file) override;
 
+    bool cacheKey(uint64_t& key) const override;
+
 private:
 
     std::string mConfig;
@@ -34,6 +36,8 @@ public:
 
     bool writeData(const ProjectSettings& settings, std::ostream& file) override;
 
+    bool cacheKey(uint64_t& key) const override;
+
 private:
 
     std::string mConfig;
@@ -1,9 +1,14 @@
 #include "fileoptions.h"
 
+#include "modelversion.h"
+#include "utils.h"
+
 FileOptions::FileOptions() :
     mLinkOrder(-1),
     mExcludeFromBuild(false),
-    mBuildCondition(BuildStep::IF_ANY_FILE_BUILDS)
+    mBuildCondition(BuildStep::IF_ANY_FILE_BUILDS),
+    mHash(0),
+    mHashValid(false)
 {
 
 }
@@ -15,11 +20,28 @@ FileOptions::FileOptions(const FileOptions& other) :
     mOptionsAdded(other.mOptionsAdded),
     mOptionsRemoved(other.mOptionsRemoved),
     mPreBuildSteps(other.mPreBuildSteps),
-    mPostBuildSteps(other.mPostBuildSteps)
+    mPostBuildSteps(other.mPostBuildSteps),
+    mHash(other.mHash),
+    mHashValid(other.mHashValid)
 {
 
 }
 
+FileOptions::FileOptions(FileOptions&& other) noexcept :
+    mLinkOrder(other.mLinkOrder),
+    mExcludeFromBuild(other.mExcludeFromBuild),
+    mBuildCondition(other.mBuildCondition),
+    mOptionsAdded(std::move(other.mOptionsAdded)),
+    mOptionsRemoved(std::move(other.mOptionsRemoved)),
+    mPreBuildSteps(std::move(other.mPreBuildSteps)),
+    mPostBuildSteps(std::move(other.mPostBuildSteps)),
+    mHash(other.mHash),
+    mHashValid(other.mHashValid)
+{
+    other.mHashValid = false;
+    ModelVersion::bump();
+}
+
 FileOptions& FileOptions::operator=(const FileOptions& other)
 {
     this->mLinkOrder = other.mLinkOrder;
@@ -29,12 +51,39 @@ FileOptions& FileOptions::operator=(const FileOptions& other)
     this->mOptionsRemoved = other.mOptionsRemoved;
     this->mPreBuildSteps = other.mPreBuildSteps;
     this->mPostBuildSteps = other.mPostBuildSteps;
+    this->mHash = other.mHash;
+    this->mHashValid = other.mHashValid;
+
+    ModelVersion::bump();
+
+    return *this;
+}
+
+FileOptions& FileOptions::operator=(FileOptions&& other) noexcept
+{
+    this->mLinkOrder = other.mLinkOrder;
+    this->mExcludeFromBuild = other.mExcludeFromBuild;
+    this->mBuildCondition = other.mBuildCondition;
+    this->mOptionsAdded = std::move(other.mOptionsAdded);
+    this->mOptionsRemoved = std::move(other.mOptionsRemoved);
+    this->mPreBuildSteps = std::move(other.mPreBuildSteps);
+    this->mPostBuildSteps = std::move(other.mPostBuildSteps);
+    this->mHash = other.mHash;
+    this->mHashValid = other.mHashValid;
+
+    other.mHashValid = false;
+    ModelVersion::bump();
 
     return *this;
 }
 
 bool FileOptions::operator==(const FileOptions& other) const
 {
+    if (hash() != other.hash())
+    {
+        return false;
+    }
+
     if (mLinkOrder != other.mLinkOrder)
     {
         return false;
@@ -108,6 +157,40 @@ bool FileOptions::isDefault(bool considerLinkOrder, bool considerExcludeFromBuil
     return true;
 }
 
+uint64_t FileOptions::hash() const
+{
+    if (not mHashValid)
+    {
+        uint64_t result = hash_combine(0, (uint64_t)(mLinkOrder + 1));
+
+        result = hash_combine(result, mExcludeFromBuild ? 1 : 0);
+        result = hash_combine(result, (uint64_t)mBuildCondition);
+
+        result = hash_combine(result, mOptionsAdded.size());
+
+        for (const InternedString& option : mOptionsAdded)
+        {
+            result = hash_combine(result, hash_string(option.str()));
+        }
+
+        result = hash_combine(result, mOptionsRemoved.size());
+
+        for (const InternedString& option : mOptionsRemoved)
+        {
+            result = hash_combine(result, hash_string(option.str()));
+        }
+
+        mHash      = result;
+        mHashValid = true;
+    }
+
+    //// Build steps keep their own hash and may change through a reference ---
+
+    uint64_t result = hash_combine(mHash, mPreBuildSteps.hash());
+
+    return hash_combine(result, mPostBuildSteps.hash());
+}
+
 int FileOptions::linkOrder() const
 {
     return mLinkOrder;
@@ -115,11 +198,17 @@ int FileOptions::linkOrder() const
 
 void FileOptions::setLinkOrder(unsigned int linkOrder)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mLinkOrder = (int)linkOrder;
 }
 
 void FileOptions::removeLinkOrder()
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mLinkOrder = -1;
 }
 
@@ -130,6 +219,9 @@ bool FileOptions::isExcludedFromBuild() const
 
 void FileOptions::setExcludeFromBuild(bool excludeFromBuild)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mExcludeFromBuild = excludeFromBuild;
 }
 
@@ -140,46 +232,87 @@ int FileOptions::buildCondition() const
 
 void FileOptions::setBuildCondition(int buildCondition)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mBuildCondition = (BuildStep::BuildCondition)buildCondition;
 }
 
 std::set<std::string> FileOptions::optionsAdded() const
 {
-    return mOptionsAdded;
+    return std::set<std::string>(mOptionsAdded.begin(), mOptionsAdded.end());
 }
 
 std::set<std::string> FileOptions::optionsRemoved() const
+{
+    return std::set<std::string>(mOptionsRemoved.begin(), mOptionsRemoved.end());
+}
+
+const internedset& FileOptions::c_optionsAdded() const
+{
+    return mOptionsAdded;
+}
+
+const internedset& FileOptions::c_optionsRemoved() const
 {
     return mOptionsRemoved;
 }
 
 void FileOptions::addOptionAdded(const std::string& option)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mOptionsAdded.insert(option);
 }
 
 void FileOptions::addOptionRemoved(const std::string& option)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mOptionsRemoved.insert(option);
 }
 
 void FileOptions::removeOptionAdded(const std::string& option)
 {
-    mOptionsAdded.erase(option);
+    mHashValid = false;
+    ModelVersion::bump();
+
+    const std::string* interned = StringPool::instance().find(option);
+
+    if (interned != nullptr)
+    {
+        mOptionsAdded.erase(InternedString(interned));
+    }
 }
 
 void FileOptions::removeOptionRemoved(const std::string& option)
 {
-    mOptionsRemoved.erase(option);
+    mHashValid = false;
+    ModelVersion::bump();
+
+    const std::string* interned = StringPool::instance().find(option);
+
+    if (interned != nullptr)
+    {
+        mOptionsRemoved.erase(InternedString(interned));
+    }
 }
 
 void FileOptions::clearOptionsAdded()
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mOptionsAdded.clear();
 }
 
 void FileOptions::clearOptionsRemoved()
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mOptionsRemoved.clear();
 }
 
@@ -193,6 +326,11 @@ BuildStepList& FileOptions::preBuildSteps()
     return mPreBuildSteps;
 }
 
+const BuildStepList& FileOptions::c_preBuildSteps() const
+{
+    return mPreBuildSteps;
+}
+
 BuildStepList FileOptions::postBuildSteps() const
 {
     return mPostBuildSteps;
@@ -202,3 +340,8 @@ BuildStepList& FileOptions::postBuildSteps()
 {
     return mPostBuildSteps;
 }
+
+const BuildStepList& FileOptions::c_postBuildSteps() const
+{
+    return mPostBuildSteps;
+}
@@ -3,21 +3,31 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
+#include "arena.h"
 #include "buildsteplist.h"
+#include "cowptr.h"
+#include "stringpool.h"
+
+typedef std::set<InternedString, std::less<InternedString>, ArenaAllocator<InternedString> > internedset;
 
 class FileOptions
 {
 public:
     FileOptions();
     FileOptions(const FileOptions& other);
+    FileOptions(FileOptions&& other) noexcept;
 
     FileOptions& operator=(const FileOptions& other);
+    FileOptions& operator=(FileOptions&& other) noexcept;
     bool operator==(const FileOptions& other) const;
     bool operator!=(const FileOptions& other) const;
 
     bool isDefault(bool considerLinkOrder = true, bool considerExcludeFromBuild = true) const;
 
+    uint64_t hash() const;
+
     int linkOrder() const;
     void setLinkOrder(unsigned int linkOrder);
     void removeLinkOrder();
@@ -31,6 +41,9 @@ public:
     std::set<std::string> optionsAdded() const;
     std::set<std::string> optionsRemoved() const;
 
+    const internedset& c_optionsAdded() const;
+    const internedset& c_optionsRemoved() const;
+
     void addOptionAdded(const std::string& option);
     void addOptionRemoved(const std::string& option);
 
@@ -42,9 +55,11 @@ public:
 
     BuildStepList preBuildSteps() const;
     BuildStepList& preBuildSteps();
+    const BuildStepList& c_preBuildSteps() const;
 
     BuildStepList postBuildSteps() const;
     BuildStepList& postBuildSteps();
+    const BuildStepList& c_postBuildSteps() const;
 
 private:
 
@@ -54,12 +69,20 @@ private:
 
     BuildStep::BuildCondition mBuildCondition;
 
-    std::set<std::string> mOptionsAdded;
-    std::set<std::string> mOptionsRemoved;
+    internedset mOptionsAdded;
+    internedset mOptionsRemoved;
 
     BuildStepList mPreBuildSteps;
     BuildStepList mPostBuildSteps;
 
+    mutable uint64_t mHash;
+    mutable bool     mHashValid;
+
 };
 
+// Per-file options of a configuration indexed by project file id, files
+// without overrides hold a null block
+
+typedef std::vector< CowPtr<FileOptions> > fileoptionstable;
+
 #endif // FILEOPTIONS_H
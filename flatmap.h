@@ -0,0 +1,384 @@
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Map stored as a sorted vector of pairs. New keys go to a short tail, kept
+// sorted on its own, that is merged in once it outgrows the square root of the
+// sorted part. Inserting into the tail and merging then cost about the same,
+// so building n entries takes O(n * sqrt(n)) moves. Iteration walks both parts
+// in key order without reordering them, so reads never move elements; only
+// insertions and freeze() do. freeze() merges the tail and releases spare
+// capacity once the map is complete.
+
+template <typename Key, typename Value, typename Compare = std::less<Key> >
+class FlatMap
+{
+public:
+    typedef std::pair<Key, Value> value_type;
+
+private:
+
+    typedef std::vector<value_type> storage;
+
+    // Visits the sorted part and the tail in merged order
+
+    template <typename Map, typename Pointer, typename Reference>
+    class MergeIterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename FlatMap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Pointer   pointer;
+        typedef Reference reference;
+
+        MergeIterator() : mMap(nullptr), mSortedPos(0), mTailPos(0)
+        {
+
+        }
+
+        MergeIterator(Map* map, size_t sortedPos, size_t tailPos) :
+            mMap(map),
+            mSortedPos(sortedPos),
+            mTailPos(tailPos)
+        {
+
+        }
+
+        // Mutable iterators convert to constant ones
+
+        template <typename OtherMap, typename OtherPointer, typename OtherReference>
+        MergeIterator(const MergeIterator<OtherMap, OtherPointer, OtherReference>& other) :
+            mMap(other.mMap),
+            mSortedPos(other.mSortedPos),
+            mTailPos(other.mTailPos)
+        {
+
+        }
+
+        Reference operator*() const
+        {
+            return mMap->mData[inTail() ? mTailPos : mSortedPos];
+        }
+
+        Pointer operator->() const
+        {
+            return &mMap->mData[inTail() ? mTailPos : mSortedPos];
+        }
+
+        MergeIterator& operator++()
+        {
+            if (inTail())
+            {
+                ++mTailPos;
+            }
+            else
+            {
+                ++mSortedPos;
+            }
+
+            return *this;
+        }
+
+        MergeIterator operator++(int)
+        {
+            MergeIterator result(*this);
+            ++(*this);
+            return result;
+        }
+
+        template <typename OtherMap, typename OtherPointer, typename OtherReference>
+        bool operator==(const MergeIterator<OtherMap, OtherPointer, OtherReference>& other) const
+        {
+            return (mSortedPos == other.mSortedPos && mTailPos == other.mTailPos);
+        }
+
+        template <typename OtherMap, typename OtherPointer, typename OtherReference>
+        bool operator!=(const MergeIterator<OtherMap, OtherPointer, OtherReference>& other) const
+        {
+            return not (*this == other);
+        }
+
+    private:
+
+        Map*   mMap;
+        size_t mSortedPos;      // In [0, sorted)
+        size_t mTailPos;        // In [sorted, size)
+
+        bool inTail() const
+        {
+            if (mSortedPos == mMap->mSorted)
+            {
+                return true;
+            }
+
+            if (mTailPos == mMap->mData.size())
+            {
+                return false;
+            }
+
+            return Compare()(mMap->mData[mTailPos].first, mMap->mData[mSortedPos].first);
+        }
+
+        template <typename, typename, typename> friend class MergeIterator;
+    };
+
+public:
+    typedef MergeIterator<FlatMap, value_type*, value_type&>                   iterator;
+    typedef MergeIterator<const FlatMap, const value_type*, const value_type&> const_iterator;
+
+    FlatMap() : mSorted(0)
+    {
+
+    }
+
+    bool operator==(const FlatMap& other) const
+    {
+        return (size() == other.size() && std::equal(begin(), end(), other.begin()));
+    }
+
+    bool operator!=(const FlatMap& other) const
+    {
+        return !(*this == other);
+    }
+
+    //// Iteration =============================================================
+
+    iterator begin()
+    {
+        return iterator(this, 0, mSorted);
+    }
+
+    iterator end()
+    {
+        return iterator(this, mSorted, mData.size());
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0, mSorted);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(this, mSorted, mData.size());
+    }
+
+    bool   empty() const
+    {
+        return mData.empty();
+    }
+
+    size_t size() const
+    {
+        return mData.size();
+    }
+
+    //// Lookup ================================================================
+
+    iterator find(const Key& key)
+    {
+        size_t index = findIndex(key);
+
+        return (index == mData.size()) ? end() : iterator(this, sortedPos(index, key), tailPos(index, key));
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        size_t index = findIndex(key);
+
+        return (index == mData.size()) ? end() : const_iterator(this, sortedPos(index, key), tailPos(index, key));
+    }
+
+    size_t count(const Key& key) const
+    {
+        return (findIndex(key) != mData.size()) ? 1 : 0;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        return mData[findIndex(key)].second;
+    }
+
+    //// Modification ==========================================================
+
+    Value& operator[](const Key& key)
+    {
+        size_t index = findIndex(key);
+
+        if (index != mData.size())
+        {
+            return mData[index].second;
+        }
+
+        return mData[insertIndex(value_type(key, Value()))].second;
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        size_t index = findIndex(value.first);
+
+        if (index != mData.size())
+        {
+            return std::make_pair(iterator(this, sortedPos(index, value.first), tailPos(index, value.first)), false);
+        }
+
+        Key key = value.first;
+
+        index = insertIndex(std::move(value));
+
+        return std::make_pair(iterator(this, sortedPos(index, key), tailPos(index, key)), true);
+    }
+
+    size_t erase(const Key& key)
+    {
+        size_t index = findIndex(key);
+
+        if (index == mData.size())
+        {
+            return 0;
+        }
+
+        if (index < mSorted)
+        {
+            --mSorted;
+        }
+
+        mData.erase(mData.begin() + index);
+
+        return 1;
+    }
+
+    void clear()
+    {
+        mData.clear();
+        mSorted = 0;
+    }
+
+    void reserve(size_t size)
+    {
+        mData.reserve(size);
+    }
+
+    //// Freeze ================================================================
+
+    void freeze()
+    {
+        mergeTail();
+
+        mData.shrink_to_fit();
+    }
+
+private:
+
+    static const size_t sMinTail = 64;
+
+    struct KeyCompare
+    {
+        bool operator()(const value_type& left, const value_type& right) const
+        {
+            return Compare()(left.first, right.first);
+        }
+
+        bool operator()(const value_type& left, const Key& right) const
+        {
+            return Compare()(left.first, right);
+        }
+
+        bool operator()(const Key& left, const value_type& right) const
+        {
+            return Compare()(left, right.first);
+        }
+    };
+
+    // Adds a missing key to the tail in order, or merges the full tail into
+    // the sorted part; returns the index of the new element
+
+    size_t insertIndex(value_type&& value)
+    {
+        typename storage::iterator position = std::upper_bound(mData.begin() + mSorted, mData.end(), value, KeyCompare());
+
+        Key key = value.first;
+
+        position = mData.insert(position, std::move(value));
+
+        size_t tail = mData.size() - mSorted;
+
+        if (tail > sMinTail && tail * tail > mSorted)
+        {
+            mergeTail();
+            return findIndex(key);
+        }
+
+        return (size_t)(position - mData.begin());
+    }
+
+    void mergeTail()
+    {
+        if (mSorted == mData.size())
+        {
+            return;
+        }
+
+        std::inplace_merge(mData.begin(), mData.begin() + mSorted, mData.end(), KeyCompare());
+
+        mSorted = mData.size();
+    }
+
+    // Index of the element, size() when missing; both parts are sorted
+
+    size_t findIndex(const Key& key) const
+    {
+        typename storage::const_iterator sortedEnd = mData.begin() + mSorted;
+
+        typename storage::const_iterator it = std::lower_bound(mData.begin(), sortedEnd, key, KeyCompare());
+
+        if (it != sortedEnd && not Compare()(key, it->first))
+        {
+            return (size_t)(it - mData.begin());
+        }
+
+        it = std::lower_bound(sortedEnd, mData.end(), key, KeyCompare());
+
+        if (it != mData.end() && not Compare()(key, it->first))
+        {
+            return (size_t)(it - mData.begin());
+        }
+
+        return mData.size();
+    }
+
+    //// Iterator positions of an element --------------------------------------
+
+    // An element of one part sits before the first larger key of the other
+
+    size_t sortedPos(size_t index, const Key& key) const
+    {
+        if (index < mSorted)
+        {
+            return index;
+        }
+
+        return (size_t)(std::upper_bound(mData.begin(), mData.begin() + mSorted, key, KeyCompare()) - mData.begin());
+    }
+
+    size_t tailPos(size_t index, const Key& key) const
+    {
+        if (index >= mSorted)
+        {
+            return index;
+        }
+
+        return (size_t)(std::upper_bound(mData.begin() + mSorted, mData.end(), key, KeyCompare()) - mData.begin());
+    }
+
+    storage mData;
+    size_t  mSorted;
+};
+
+#endif // FLATMAP_H
@@ -1,9 +1,21 @@
 ﻿#include "projectreader.h"
+#include "arena.h"
+#include "buildtrace.h"
+#include "outputcache.h"
+#include "parsecache.h"
+#include "stringpool.h"
 #include "export/projectexportccs3.h"
+#include "export/projectexportcompiled.h"
+#include "export/projectexportgraph.h"
 #include "export/projectexportmakefile.h"
 #include "export/projectexportqtmakefile.h"
 
+#include <errno.h>
+#include <stdlib.h>
 #include <iostream>
+#include <fstream>
+#include <memory>
+#include <string.h>
 #include <strings.h>
 
 #include "utils.h"
@@ -19,10 +31,14 @@ enum Args
 enum OutputFormats
 {
     OF_PJT,
+    OF_PJTC,
     OF_MAKEFILE,
     OF_QT_MAKE_SOURCES,
     OF_QT_MAKE_DEFINES,
     OF_QT_MAKE_INCLUDES,
+    OF_GRAPH,
+    OF_GRAPH_DOT,
+    OF_GRAPH_JSON,
 
     OF_COUNT
 };
@@ -30,21 +46,272 @@ enum OutputFormats
 static const char* const FORMAT_NAMES[OF_COUNT] =
 {
     "pjt",
+    "pjtc",
     "make",
     "qt_make_sources",
     "qt_make_defines",
-    "qt_make_includes"
+    "qt_make_includes",
+    "graph",
+    "graph_dot",
+    "graph_json"
 };
 
 void usage(const char* exec)
 {
     std::cerr << "Usage: " << exec
-              << " input [format1 output1] [format2 output2]..."
+              << " [options] input [format1 output1] [format2 output2]..."
               << std::endl;
+
+    std::cerr << "Options:" << std::endl
+              << "  --response-files    pass compiler and linker options through option files" << std::endl
+              << "                      (needs GNU make 4.0 or later for $(file ...))" << std::endl
+              << "  --build-times=FILE  record compile times to FILE and build longest jobs first,"
+              << std::endl
+              << "                      graph formats use them as job weights" << std::endl
+              << "  --trace=DIR         record every build job to a trace log in DIR"
+              << std::endl
+              << "  --string-stats      report memory saved by the string pool" << std::endl
+              << "  --arena             allocate the parsed project from one arena freed at exit" << std::endl
+              << "  --cache=DIR         reuse outputs rendered from identical input in DIR" << std::endl
+              << "  --cache-size=MB     evict least recently used outputs past MB (default 64)" << std::endl
+              << "  --cache-entries=N   evict least recently used outputs past N (default 1024)" << std::endl
+              << "  --parse-cache[=DIR] share parsed projects between concurrent runs in DIR" << std::endl
+              << "                      (default " << ParseCache::defaultDirectory() << ")" << std::endl;
+
+    std::cerr << "       " << exec
+              << " trace [--top=N] output.json log1 [log2]..."
+              << std::endl;
+
+    std::cerr << "       " << exec
+              << " cache-stats DIR"
+              << std::endl;
+}
+
+int trace(int argc, char* argv[])
+{
+    size_t top = 20;
+    int    arg = 2;
+
+    if (argc > arg && starts_with(argv[arg], "--top="))
+    {
+        top = strtoul(argv[arg] + strlen("--top="), nullptr, 10);
+        ++arg;
+    }
+
+    if (argc <= arg + 1)
+    {
+        usage(argv[0]);
+        std::cerr << "Missing trace output or log arguments" << std::endl;
+        return 1;
+    }
+
+    const char* outputPath = argv[arg++];
+
+    //// Merge logs ============================================================
+
+    BuildTrace buildTrace;
+
+    for (; arg < argc; ++arg)
+    {
+        if (not buildTrace.load(argv[arg]))
+        {
+            std::cerr << buildTrace.lastError() << std::endl;
+            return 2;
+        }
+    }
+
+    //// Write trace and report ================================================
+
+    std::ofstream output(outputPath);
+
+    if (not output.is_open())
+    {
+        std::cerr << "Failed to open trace output '" << outputPath << "': '" << strerror(errno) << "'" << std::endl;
+        return 3;
+    }
+
+    buildTrace.writeChromeTrace(output);
+    buildTrace.writeReport(std::cout, top);
+
+    return 0;
+}
+
+int cacheStats(int argc, char* argv[])
+{
+    if (argc <= 2)
+    {
+        usage(argv[0]);
+        std::cerr << "Missing cache directory argument" << std::endl;
+        return 1;
+    }
+
+    OutputCache cache;
+    OutputCache::Stats stats;
+
+    uint64_t bytes   = 0;
+    size_t   entries = 0;
+
+    if (not cache.open(argv[2]) || not cache.loadStats(stats) || not cache.usage(bytes, entries))
+    {
+        std::cerr << cache.lastError() << std::endl;
+        return 2;
+    }
+
+    uint64_t lookups = stats.hits + stats.misses;
+
+    std::cout << string_format("Entries: %u (%u KiB)", (unsigned int)entries, (unsigned int)(bytes / 1024)) << std::endl;
+    std::cout << string_format("Lookups: %u, %u hits, %u misses, hit ratio %.1f%%",
+                               (unsigned int)lookups,
+                               (unsigned int)stats.hits,
+                               (unsigned int)stats.misses,
+                               lookups == 0 ? 0.0 : 100.0 * (double)stats.hits / (double)lookups)
+              << std::endl;
+    std::cout << string_format("Stores: %u, evictions: %u", (unsigned int)stats.stores, (unsigned int)stats.evictions) << std::endl;
+
+    return 0;
+}
+
+static bool readProject(ProjectReader& reader, ParseCache& parses, const char* path, ProjectSettings& settings, bool stringStats)
+{
+    // Of the runs missing the same project at once only one parses it, the
+    // others map its result
+
+    if (parses.isOpen())
+    {
+        if (parses.find(path, settings))
+        {
+            return true;
+        }
+
+        if (not parses.claim(path) && parses.wait(path, settings))
+        {
+            return true;
+        }
+    }
+
+    reader.setHashSource(parses.isOpen());
+
+    if (not reader.read())
+    {
+        std::cerr << reader.lastError() << std::endl;
+        parses.release();
+        return false;
+    }
+
+    settings = reader.takeProjectSettings();
+
+    if (parses.isOpen())
+    {
+        if (not parses.publish(path, settings, reader.sourceStamp()))
+        {
+            std::cerr << parses.lastError() << std::endl;
+        }
+
+        parses.release();
+    }
+
+    if (stringStats)
+    {
+        const StringPool& pool = StringPool::instance();
+
+        std::cerr << string_format("Strings: %u requested (%u bytes), %u unique (%u bytes), %u bytes saved",
+                                   (unsigned int)pool.requests(),
+                                   (unsigned int)pool.requestedBytes(),
+                                   (unsigned int)pool.size(),
+                                   (unsigned int)pool.storedBytes(),
+                                   (unsigned int)pool.savedBytes())
+                  << std::endl;
+    }
+
+    return true;
 }
 
 int main(int argc, char* argv[])
 {
+    //// Subcommands ===========================================================
+
+    if (argc > 1 && strcmp(argv[1], "trace") == 0)
+    {
+        return trace(argc, argv);
+    }
+
+    if (argc > 1 && strcmp(argv[1], "cache-stats") == 0)
+    {
+        return cacheStats(argc, argv);
+    }
+
+    //// Parse options =========================================================
+
+    bool        responseFiles = false;
+    std::string buildTimes;
+    std::string traceDir;
+    bool        stringStats = false;
+    bool        useArena    = false;
+    std::string cacheDir;
+    uint64_t    cacheSize    = 64;
+    size_t      cacheEntries = 1024;
+    std::string parseCacheDir;
+
+    int options = 0;
+
+    while (argc > ARG_IN_FILE + options && starts_with(argv[ARG_IN_FILE + options], "--"))
+    {
+        const char* option = argv[ARG_IN_FILE + options];
+
+        if (strcasecmp(option, "--response-files") == 0)
+        {
+            responseFiles = true;
+        }
+        else if (starts_with(option, "--build-times="))
+        {
+            buildTimes = option + strlen("--build-times=");
+        }
+        else if (starts_with(option, "--trace="))
+        {
+            traceDir = option + strlen("--trace=");
+        }
+        else if (strcasecmp(option, "--string-stats") == 0)
+        {
+            stringStats = true;
+        }
+        else if (strcasecmp(option, "--arena") == 0)
+        {
+            useArena = true;
+        }
+        else if (starts_with(option, "--cache="))
+        {
+            cacheDir = option + strlen("--cache=");
+        }
+        else if (starts_with(option, "--cache-size="))
+        {
+            cacheSize = strtoull(option + strlen("--cache-size="), nullptr, 10);
+        }
+        else if (starts_with(option, "--cache-entries="))
+        {
+            cacheEntries = strtoul(option + strlen("--cache-entries="), nullptr, 10);
+        }
+        else if (strcasecmp(option, "--parse-cache") == 0)
+        {
+            parseCacheDir = ParseCache::defaultDirectory();
+        }
+        else if (starts_with(option, "--parse-cache="))
+        {
+            parseCacheDir = option + strlen("--parse-cache=");
+        }
+        else
+        {
+            usage(argv[0]);
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+
+        ++options;
+    }
+
+    argv[options] = argv[ARG_EXEC];
+    argv += options;
+    argc -= options;
+
     //// Check argument count ==================================================
 
     if (argc <= ARG_IN_FILE)
@@ -54,17 +321,68 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    //// Open output cache =====================================================
+
+    // Outputs are keyed by the input bytes, so a hit needs no parsing at all
+
+    OutputCache cache;
+    uint64_t    inputKey = 0;
+
+    if (not cacheDir.empty())
+    {
+        std::string input;
+
+        if (not cache.open(cacheDir))
+        {
+            std::cerr << cache.lastError() << std::endl;
+        }
+        else if (read_file(argv[ARG_IN_FILE], input))
+        {
+            cache.setLimits(cacheSize * 1024 * 1024, cacheEntries);
+
+            inputKey = OutputCache::toolKey(argv[ARG_EXEC]);
+            inputKey = hash_combine(inputKey, hash_bytes(input.data(), input.size()));
+        }
+    }
+
+    bool useCache = (cache.isOpen() && inputKey != 0);
+
+    //// Open parse cache ======================================================
+
+    ParseCache parses;
+
+    if (not parseCacheDir.empty() && not parses.open(parseCacheDir))
+    {
+        std::cerr << parses.lastError() << std::endl;
+    }
+
     //// Read project file =====================================================
 
-    ProjectReader reader(argv[1]);
+    // The parsed model is never modified, so its containers may be carved
+    // from one arena and freed together at exit
 
-    if (not reader.read())
+    Arena                       arena;
+    std::unique_ptr<ArenaScope> arenaScope;
+
+    if (useArena)
     {
-        std::cerr << reader.lastError() << std::endl;
-        return 2;
+        arenaScope.reset(new ArenaScope(arena));
     }
 
-    ProjectSettings settings = reader.projectSettings();
+    ProjectReader   reader(argv[1]);
+    ProjectSettings settings;
+
+    bool parsed = false;
+
+    if (not useCache)
+    {
+        if (not readProject(reader, parses, argv[ARG_IN_FILE], settings, stringStats))
+        {
+            return 2;
+        }
+
+        parsed = true;
+    }
 
     //// Write output ==========================================================
 
@@ -128,10 +446,26 @@ int main(int argc, char* argv[])
             break;
         }
 
+        case OF_PJTC:
+        {
+            writer = new ProjectExportCompiled;
+            break;
+        }
+
         case OF_MAKEFILE:
         {
             ProjectExportMakefile* writerMakefile = new ProjectExportMakefile;
             writerMakefile->setTarget(argv[ARG_OUT_FILE + currIndex]);
+            writerMakefile->setResponseFiles(responseFiles);
+            writerMakefile->setSourceDir(dirname(argv[ARG_IN_FILE]));
+
+            if (not buildTimes.empty())
+            {
+                writerMakefile->setBuildTimes(buildTimes);
+            }
+
+            writerMakefile->setTraceDir(traceDir);
+
             writer = writerMakefile;
             break;
         }
@@ -156,6 +490,36 @@ int main(int argc, char* argv[])
             break;
         }
 
+        case OF_GRAPH:
+        case OF_GRAPH_DOT:
+        case OF_GRAPH_JSON:
+        {
+            ProjectExportGraph* writerGraph = nullptr;
+
+            if (format == OF_GRAPH)
+            {
+                writerGraph = new ProjectExportGraphReport;
+            }
+            else if (format == OF_GRAPH_DOT)
+            {
+                writerGraph = new ProjectExportGraphDot;
+            }
+            else
+            {
+                writerGraph = new ProjectExportGraphJson;
+            }
+
+            writerGraph->setSourceDir(dirname(argv[ARG_IN_FILE]));
+
+            if (not buildTimes.empty())
+            {
+                writerGraph->setBuildTimes(buildTimes);
+            }
+
+            writer = writerGraph;
+            break;
+        }
+
         case OF_COUNT:
         {
             break;
@@ -168,7 +532,50 @@ int main(int argc, char* argv[])
             return 3;
         }
 
-        if (not writer->write(settings, argv[ARG_OUT_FILE + currIndex]))
+        // Formats taking a configuration name have used up one more argument
+
+        if (argc <= ARG_OUT_FILE + currIndex)
+        {
+            usage(argv[0]);
+            std::cerr << "Missing output path argument" << std::endl;
+            return 1;
+        }
+
+        uint64_t outputKey = 0;
+        bool     cached    = useCache && writer->cacheKey(outputKey);
+
+        // Outputs may name their own file, so the path is part of the key
+
+        outputKey = hash_string(FORMAT_NAMES[format], hash_combine(inputKey, outputKey));
+        outputKey = hash_string(argv[ARG_OUT_FILE + currIndex], outputKey);
+
+        std::string text;
+
+        if (not cached || not cache.load(outputKey, text))
+        {
+            if (not parsed)
+            {
+                if (not readProject(reader, parses, argv[ARG_IN_FILE], settings, stringStats))
+                {
+                    return 2;
+                }
+
+                parsed = true;
+            }
+
+            if (not writer->render(settings, text, argv[ARG_OUT_FILE + currIndex]))
+            {
+                std::cerr << writer->lastError() << std::endl;
+                return 3;
+            }
+
+            if (cached && not cache.store(outputKey, text))
+            {
+                std::cerr << cache.lastError() << std::endl;
+            }
+        }
+
+        if (not writer->writeText(text, argv[ARG_OUT_FILE + currIndex]))
         {
             std::cerr << writer->lastError() << std::endl;
             return 3;
@@ -181,5 +588,15 @@ int main(int argc, char* argv[])
 
     //// =======================================================================
 
+    // Done with the project, so its strings go before a next one is read
+
+    settings = ProjectSettings();
+    StringPool::instance().clear();
+
+    if (not cache.saveStats())
+    {
+        std::cerr << cache.lastError() << std::endl;
+    }
+
     return 0;
 }
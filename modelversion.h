@@ -0,0 +1,35 @@
+#ifndef MODELVERSION_H
+#define MODELVERSION_H
+
+#include <stdint.h>
+
+// Version of the project model, moved on by every change to build steps, file
+// options or configurations. Those are handed out by reference, so an owner
+// caching a hash over them cannot be told of a change; it keeps the version
+// the hash was computed at instead and recomputes once the version moved on.
+
+class ModelVersion
+{
+public:
+    static const uint64_t NONE = ~0ull;
+
+    static uint64_t current()
+    {
+        return counter();
+    }
+
+    static void bump()
+    {
+        ++counter();
+    }
+
+private:
+
+    static uint64_t& counter()
+    {
+        static uint64_t version = 0;
+        return version;
+    }
+};
+
+#endif // MODELVERSION_H
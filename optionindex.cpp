@@ -0,0 +1,149 @@
+#include "optionindex.h"
+
+#include <algorithm>
+#include <ctype.h>
+
+#include "utils.h"
+
+static std::string fold(const std::string& str)
+{
+    std::string result(str);
+
+    for (char& c : result)
+    {
+        c = (char)tolower((unsigned char)c);
+    }
+
+    return result;
+}
+
+static std::string optionValue(const std::string& option, std::string::size_type keyLength)
+{
+    std::string value;
+
+    if ((option.length() > keyLength) && (option.at(keyLength) == '='))
+    {
+        value = option.substr(keyLength + 1);
+    }
+    else
+    {
+        value = option.substr(keyLength);
+    }
+
+    remove_quotes(value);
+
+    return value;
+}
+
+//// Option index ==============================================================
+
+bool OptionIndex::Entry::operator<(const Entry& other) const
+{
+    return (folded < other.folded) || (folded == other.folded && position < other.position);
+}
+
+OptionIndex::OptionIndex() : mBuilt(false)
+{
+
+}
+
+void OptionIndex::clear()
+{
+    if (not mBuilt)
+    {
+        return;
+    }
+
+    mOptions.clear();
+    mEntries.clear();
+    mPairs.clear();
+    mMemo.clear();
+
+    mBuilt = false;
+}
+
+bool OptionIndex::isBuilt() const
+{
+    return mBuilt;
+}
+
+void OptionIndex::build(const std::vector<std::string>& options)
+{
+    clear();
+
+    mOptions = options;
+
+    mEntries.reserve(options.size());
+    mPairs.reserve(options.size());
+
+    for (unsigned int position = 0; position < options.size(); ++position)
+    {
+        const std::string& option = options[position];
+
+        Entry entry;
+        entry.folded   = fold(option);
+        entry.position = position;
+
+        mEntries.push_back(std::move(entry));
+
+        //// Bulk pairs: the key ends at '=' or an attached quoted value ------
+
+        std::string::size_type keyLength = option.find_first_of("=\"", 1);
+
+        if (keyLength == std::string::npos)
+        {
+            mPairs.push_back(optionpair(option, std::string()));
+        }
+        else
+        {
+            mPairs.push_back(optionpair(option.substr(0, keyLength), optionValue(option, keyLength)));
+        }
+    }
+
+    std::sort(mEntries.begin(), mEntries.end());
+
+    mBuilt = true;
+}
+
+bool OptionIndex::find(const std::string& key, std::string& value)
+{
+    std::unordered_map<std::string, Result>::const_iterator known = mMemo.find(key);
+
+    if (known != mMemo.end())
+    {
+        value = known->second.value;
+        return known->second.found;
+    }
+
+    //// Options starting with the key sort next to each other ----------------
+
+    Entry probe;
+    probe.folded   = fold(key);
+    probe.position = 0;
+
+    std::vector<Entry>::const_iterator it = std::lower_bound(mEntries.begin(), mEntries.end(), probe);
+
+    unsigned int first = NO_POSITION;
+
+    for (; it != mEntries.end() && starts_with(it->folded, probe.folded, false); ++it)
+    {
+        first = std::min(first, it->position);
+    }
+
+    Result result;
+    result.found = (first != NO_POSITION);
+
+    if (result.found)
+    {
+        result.value = optionValue(mOptions[first], key.length());
+    }
+
+    value = result.value;
+
+    return mMemo.insert(std::make_pair(key, std::move(result))).first->second.found;
+}
+
+const optionpairs& OptionIndex::pairs() const
+{
+    return mPairs;
+}
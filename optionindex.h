@@ -0,0 +1,59 @@
+#ifndef OPTIONINDEX_H
+#define OPTIONINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+typedef std::pair<std::string, std::string> optionpair;
+typedef std::vector<optionpair>             optionpairs;
+
+//// Option index ==============================================================
+
+// Lookup of option values by flag over one option list. A flag matches the
+// first option starting with it, case-insensitive, and its value follows an
+// optional '=' with quotes removed, so "-o=x", "-ox" and "-o\"x\"" all give
+// "x" for "-o". Built on first use and answered from a memo after that
+
+class OptionIndex
+{
+public:
+    static const unsigned int NO_POSITION = 0xFFFFFFFFu;
+
+public:
+    OptionIndex();
+
+    void clear();
+    bool isBuilt() const;
+
+    void build(const std::vector<std::string>& options);
+
+    bool find(const std::string& key, std::string& value);
+
+    const optionpairs& pairs() const;
+
+private:
+
+    struct Entry
+    {
+        std::string  folded;
+        unsigned int position;
+
+        bool operator<(const Entry& other) const;
+    };
+
+    struct Result
+    {
+        bool        found;
+        std::string value;
+    };
+
+    std::vector<std::string>                mOptions;
+    std::vector<Entry>                      mEntries;
+    optionpairs                             mPairs;
+    std::unordered_map<std::string, Result> mMemo;
+
+    bool mBuilt;
+};
+
+#endif // OPTIONINDEX_H
@@ -0,0 +1,125 @@
+#include "optionlexer.h"
+
+#include <string.h>
+#include <strings.h>
+
+//// Option token ==============================================================
+
+std::string OptionToken::text() const
+{
+    return std::string(begin, end);
+}
+
+std::string OptionToken::flag() const
+{
+    return std::string(begin, flagEnd);
+}
+
+std::string OptionToken::value() const
+{
+    return std::string(valueBegin, valueEnd);
+}
+
+size_t OptionToken::length() const
+{
+    return (size_t)(end - begin);
+}
+
+bool OptionToken::isFlag(const char* flag) const
+{
+    size_t flagLength = strlen(flag);
+
+    return ((size_t)(flagEnd - begin) == flagLength) && (strncasecmp(begin, flag, flagLength) == 0);
+}
+
+bool OptionToken::isQuotedFlag(const char* flag) const
+{
+    return quoted && (*flagEnd == '"') && isFlag(flag);
+}
+
+//// Option lexer ==============================================================
+
+static inline bool is_blank(char c)
+{
+    return (c == ' ') || (c == '\t');
+}
+
+OptionLexer::OptionLexer(const char* begin, const char* end) : mPos(begin), mEnd(end)
+{
+
+}
+
+OptionLexer::OptionLexer(const std::string& line) : mPos(line.data()), mEnd(line.data() + line.size())
+{
+
+}
+
+bool OptionLexer::next(OptionToken& token)
+{
+    while (mPos != mEnd && is_blank(*mPos))
+    {
+        ++mPos;
+    }
+
+    if (mPos == mEnd)
+    {
+        return false;
+    }
+
+    //// Token, with blanks inside quotes ---------------------------------------
+
+    token.begin   = mPos;
+    token.flagEnd = nullptr;
+
+    bool inQuotes = false;
+
+    for (; mPos != mEnd; ++mPos)
+    {
+        char c = *mPos;
+
+        if (c == '"')
+        {
+            inQuotes = not inQuotes;
+        }
+        else if (is_blank(c) && not inQuotes)
+        {
+            break;
+        }
+
+        // The flag ends at the first '=' or quote past its leading character
+
+        if (token.flagEnd == nullptr && (c == '"' || c == '=') && mPos != token.begin)
+        {
+            token.flagEnd = mPos;
+        }
+    }
+
+    token.end = mPos;
+
+    //// Value -------------------------------------------------------------------
+
+    if (token.flagEnd == nullptr)
+    {
+        token.flagEnd    = token.end;
+        token.valueBegin = token.end;
+        token.valueEnd   = token.end;
+        token.quoted     = false;
+
+        return true;
+    }
+
+    token.valueBegin = (*token.flagEnd == '=') ? token.flagEnd + 1 : token.flagEnd;
+    token.valueEnd   = token.end;
+
+    token.quoted = (token.valueEnd - token.valueBegin >= 2) &&
+                   (*token.valueBegin == '"') &&
+                   (*(token.valueEnd - 1) == '"');
+
+    if (token.quoted)
+    {
+        ++token.valueBegin;
+        --token.valueEnd;
+    }
+
+    return true;
+}
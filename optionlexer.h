@@ -0,0 +1,53 @@
+#ifndef OPTIONLEXER_H
+#define OPTIONLEXER_H
+
+#include <string>
+
+//// Option token ==============================================================
+
+// One option of a cl6x command line, pointing into the lexed text. The flag
+// runs up to an attached '=' or '"'; a value in quotes right after the flag
+// makes the token quoted, as in -i"C:/Program Files/include"
+
+struct OptionToken
+{
+    const char* begin;
+    const char* end;
+
+    const char* flagEnd;
+
+    const char* valueBegin;
+    const char* valueEnd;
+
+    bool        quoted;
+
+    std::string text() const;
+    std::string flag() const;
+    std::string value() const;
+
+    size_t      length() const;
+
+    bool        isFlag(const char* flag) const;
+    bool        isQuotedFlag(const char* flag) const;
+};
+
+//// Option lexer ==============================================================
+
+// Splits an option line at blanks outside quotes in a single pass, so quoted
+// paths with spaces stay one option and empty options never appear
+
+class OptionLexer
+{
+public:
+    OptionLexer(const char* begin, const char* end);
+    explicit OptionLexer(const std::string& line);
+
+    bool next(OptionToken& token);
+
+private:
+
+    const char* mPos;
+    const char* mEnd;
+};
+
+#endif // OPTIONLEXER_H
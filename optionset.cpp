@@ -0,0 +1,222 @@
+#include "optionset.h"
+
+#include "utils.h"
+
+//// Option set ================================================================
+
+OptionSet::OptionSet(size_t size, bool value) :
+    mWords((size + 63) / 64, value ? ~(uint64_t)0 : 0),
+    mSize(size)
+{
+    // Bits past the end stay clear, so whole words compare and hash
+
+    if (value && (size % 64) != 0)
+    {
+        mWords.back() &= ((uint64_t)1 << (size % 64)) - 1;
+    }
+}
+
+bool OptionSet::operator==(const OptionSet& other) const
+{
+    return mSize == other.mSize && mWords == other.mWords;
+}
+
+bool OptionSet::operator!=(const OptionSet& other) const
+{
+    return !(*this == other);
+}
+
+OptionSet& OptionSet::operator|=(const OptionSet& other)
+{
+    for (size_t i = 0; i < mWords.size() && i < other.mWords.size(); ++i)
+    {
+        mWords[i] |= other.mWords[i];
+    }
+
+    return *this;
+}
+
+OptionSet& OptionSet::operator&=(const OptionSet& other)
+{
+    for (size_t i = 0; i < mWords.size(); ++i)
+    {
+        mWords[i] &= (i < other.mWords.size()) ? other.mWords[i] : 0;
+    }
+
+    return *this;
+}
+
+void OptionSet::subtract(const OptionSet& other)
+{
+    for (size_t i = 0; i < mWords.size() && i < other.mWords.size(); ++i)
+    {
+        mWords[i] &= ~other.mWords[i];
+    }
+}
+
+void OptionSet::set(size_t index)
+{
+    mWords[index / 64] |= (uint64_t)1 << (index % 64);
+}
+
+bool OptionSet::test(size_t index) const
+{
+    return (mWords[index / 64] >> (index % 64)) & 1;
+}
+
+size_t OptionSet::size() const
+{
+    return mSize;
+}
+
+size_t OptionSet::hash() const
+{
+    uint64_t result = mSize;
+
+    for (uint64_t word : mWords)
+    {
+        result = (result ^ word) * 0x100000001b3ull;
+    }
+
+    return (size_t)result;
+}
+
+//// Option dictionary =========================================================
+
+OptionDictionary::OptionDictionary(const ProjectSettings& settings)
+{
+    internedset options;
+
+    for (const std::string& configName : settings.configs())
+    {
+        const ConfigSettings& config = settings.c_configSettings(configName);
+
+        for (unsigned int fileId = 0; fileId < settings.fileCount(); ++fileId)
+        {
+            const internedset& added = config.c_fileOptions(fileId).c_optionsAdded();
+
+            options.insert(added.begin(), added.end());
+        }
+    }
+
+    mOptions.assign(options.begin(), options.end());
+
+    for (size_t id = 0; id < mOptions.size(); ++id)
+    {
+        mIds.insert(std::make_pair(mOptions[id], (unsigned int)id));
+    }
+
+    mIds.freeze();
+}
+
+unsigned int OptionDictionary::id(const InternedString& option) const
+{
+    return mIds.at(option);
+}
+
+const std::string& OptionDictionary::option(unsigned int id) const
+{
+    return mOptions[id];
+}
+
+size_t OptionDictionary::size() const
+{
+    return mOptions.size();
+}
+
+//// Option resolver ===========================================================
+
+bool OptionResolver::Resolved::operator==(const Resolved& other) const
+{
+    return base == other.base && added == other.added;
+}
+
+size_t OptionResolver::ResolvedHash::operator()(const Resolved& resolved) const
+{
+    return resolved.base.hash() * 31 + resolved.added.hash();
+}
+
+OptionResolver::OptionResolver(const stringlist& base, const OptionDictionary& dictionary) :
+    mBase(base),
+    mDictionary(dictionary)
+{
+
+}
+
+const OptionResolver::Resolved& OptionResolver::resolve(const FileOptions& file)
+{
+    // Shared option blocks resolve once
+
+    auto cached = mResolved.find(&file);
+
+    if (cached != mResolved.end())
+    {
+        return cached->second;
+    }
+
+    Resolved resolved;
+
+    resolved.base  = OptionSet(mBase.size(), true);
+    resolved.added = OptionSet(mDictionary.size());
+
+    for (const InternedString& option : file.c_optionsRemoved())
+    {
+        resolved.base.subtract(removeMask(option));
+    }
+
+    for (const InternedString& option : file.c_optionsAdded())
+    {
+        resolved.added.set(mDictionary.id(option));
+    }
+
+    return mResolved.insert(std::make_pair(&file, std::move(resolved))).first->second;
+}
+
+stringlist OptionResolver::options(const Resolved& resolved) const
+{
+    stringlist result;
+
+    result.reserve(mBase.size());
+
+    for (size_t index = 0; index < mBase.size(); ++index)
+    {
+        if (resolved.base.test(index))
+        {
+            result.push_back(mBase[index]);
+        }
+    }
+
+    for (size_t id = 0; id < mDictionary.size(); ++id)
+    {
+        if (resolved.added.test(id))
+        {
+            result.push_back(mDictionary.option((unsigned int)id));
+        }
+    }
+
+    return result;
+}
+
+const OptionSet& OptionResolver::removeMask(const InternedString& option)
+{
+    // A removal drops every base option it prefixes
+
+    auto cached = mRemoveMasks.find(&option.str());
+
+    if (cached != mRemoveMasks.end())
+    {
+        return cached->second;
+    }
+
+    OptionSet mask(mBase.size());
+
+    for (size_t index = 0; index < mBase.size(); ++index)
+    {
+        if (starts_with(mBase[index], option.str()))
+        {
+            mask.set(index);
+        }
+    }
+
+    return mRemoveMasks.insert(std::make_pair(&option.str(), std::move(mask))).first->second;
+}
@@ -0,0 +1,97 @@
+#ifndef OPTIONSET_H
+#define OPTIONSET_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "projectsettings.h"
+
+//// Option set ================================================================
+
+class OptionSet
+{
+public:
+    OptionSet(size_t size = 0, bool value = false);
+
+    bool operator==(const OptionSet& other) const;
+    bool operator!=(const OptionSet& other) const;
+
+    OptionSet& operator|=(const OptionSet& other);
+    OptionSet& operator&=(const OptionSet& other);
+
+    void   subtract(const OptionSet& other);
+
+    void   set(size_t index);
+    bool   test(size_t index) const;
+
+    size_t size() const;
+    size_t hash() const;
+
+private:
+
+    std::vector<uint64_t> mWords;
+    size_t                mSize;
+};
+
+//// Option dictionary =========================================================
+
+// Every option added to a file anywhere in the project, ids follow the option
+// order, so walking a set by id lists its options sorted
+
+class OptionDictionary
+{
+public:
+    explicit OptionDictionary(const ProjectSettings& settings);
+
+    unsigned int       id(const InternedString& option) const;
+    const std::string& option(unsigned int id) const;
+
+    size_t size() const;
+
+private:
+
+    std::vector<InternedString>           mOptions;
+    FlatMap<InternedString, unsigned int> mIds;
+};
+
+//// Option resolver ===========================================================
+
+// Effective compiler options of files in one configuration: which base
+// options survive the file's removals, and which dictionary options it adds
+
+class OptionResolver
+{
+public:
+    struct Resolved
+    {
+        OptionSet base;
+        OptionSet added;
+
+        bool operator==(const Resolved& other) const;
+    };
+
+    struct ResolvedHash
+    {
+        size_t operator()(const Resolved& resolved) const;
+    };
+
+public:
+    OptionResolver(const stringlist& base, const OptionDictionary& dictionary);
+
+    const Resolved& resolve(const FileOptions& file);
+
+    stringlist options(const Resolved& resolved) const;
+
+private:
+
+    const stringlist&       mBase;
+    const OptionDictionary& mDictionary;
+
+    std::unordered_map<const std::string*, OptionSet> mRemoveMasks;
+    std::unordered_map<const FileOptions*, Resolved>  mResolved;
+
+    const OptionSet& removeMask(const InternedString& option);
+};
+
+#endif // OPTIONSET_H
@@ -0,0 +1,433 @@
+#include "outputcache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+#include <algorithm>
+#include <vector>
+
+#include "utils.h"
+
+// Bumped whenever the entry layout or the key changes meaning
+
+static const char* const sCacheVersion = "ccs-pjt-parser output cache 1";
+
+static const char* const sEntrySuffix = ".out";
+
+static const uint64_t sDefaultMaxBytes   = 64ull * 1024 * 1024;
+static const size_t   sDefaultMaxEntries = 1024;
+
+static const unsigned long sCompactStatsBytes = 64 * 1024;
+
+// Files written aside by a run that died before renaming them
+
+static const time_t sStaleTempS = 60;
+
+struct CacheEntry
+{
+    std::string path;
+    uint64_t    size;
+    time_t      used;
+};
+
+static bool used_earlier(const CacheEntry& a, const CacheEntry& b)
+{
+    return a.used < b.used;
+}
+
+static std::string stats_record(const OutputCache::Stats& stats)
+{
+    return string_format("%llu %llu %llu %llu\n",
+                         (unsigned long long)stats.hits,
+                         (unsigned long long)stats.misses,
+                         (unsigned long long)stats.stores,
+                         (unsigned long long)stats.evictions);
+}
+
+static bool make_directory(const std::string& path)
+{
+#ifdef _WIN32
+    int res = mkdir(path.c_str());
+#else
+    int res = mkdir(path.c_str(), 0777);
+#endif
+
+    return (res == 0 || errno == EEXIST);
+}
+
+static bool list_entries(const std::string& directory, const char* suffix, std::vector<CacheEntry>& entries)
+{
+    DIR* dir = opendir(directory.c_str());
+
+    if (dir == nullptr)
+    {
+        return false;
+    }
+
+    while (struct dirent* item = readdir(dir))
+    {
+        if (not ends_with(item->d_name, suffix))
+        {
+            continue;
+        }
+
+        CacheEntry entry;
+        entry.path = directory + "/" + item->d_name;
+
+        struct stat entryStat;
+
+        if (stat(entry.path.c_str(), &entryStat) != 0)
+        {
+            continue;
+        }
+
+        entry.size = (uint64_t)entryStat.st_size;
+        entry.used = entryStat.st_mtime;
+
+        entries.push_back(entry);
+    }
+
+    closedir(dir);
+
+    return true;
+}
+
+static bool replace_file(const std::string& path, const std::string& text, std::string& error)
+{
+    std::string tempPath = path + string_format(".%u.tmp", (unsigned int)getpid());
+
+    FILE* file = fopen(tempPath.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        error = string_format("Failed to open cache entry '%s': '%s'", tempPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    bool written = (fwrite(text.data(), 1, text.size(), file) == text.size());
+
+    if (fclose(file) != 0 || not written)
+    {
+        error = string_format("Failed to write cache entry '%s'", tempPath.c_str());
+        remove(tempPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+
+    if (rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        error = string_format("Failed to replace cache entry '%s': '%s'", path.c_str(), strerror(errno));
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+OutputCache::OutputCache() :
+    mMaxBytes(sDefaultMaxBytes),
+    mMaxEntries(sDefaultMaxEntries)
+{
+    memset(&mStats, 0x00, sizeof(mStats));
+}
+
+bool OutputCache::open(const std::string& directory)
+{
+    mLastError.clear();
+    mDirectory.clear();
+
+    if (not make_directory(directory))
+    {
+        mLastError = string_format("Failed to create cache directory '%s': '%s'", directory.c_str(), strerror(errno));
+        return false;
+    }
+
+    mDirectory = directory;
+
+    return true;
+}
+
+bool OutputCache::isOpen() const
+{
+    return not mDirectory.empty();
+}
+
+void OutputCache::setLimits(uint64_t maxBytes, size_t maxEntries)
+{
+    mMaxBytes   = maxBytes;
+    mMaxEntries = maxEntries;
+}
+
+//// Entries ===================================================================
+
+bool OutputCache::load(uint64_t key, std::string& text)
+{
+    std::string path = entryPath(key);
+
+    if (not read_file(path, text))
+    {
+        ++mStats.misses;
+        return false;
+    }
+
+    // Touched so eviction sees it as just used
+
+    utime(path.c_str(), nullptr);
+
+    ++mStats.hits;
+
+    return true;
+}
+
+bool OutputCache::store(uint64_t key, const std::string& text)
+{
+    mLastError.clear();
+
+    if (text.size() > mMaxBytes || mMaxEntries == 0)
+    {
+        return true;
+    }
+
+    if (not replace_file(entryPath(key), text, mLastError))
+    {
+        return false;
+    }
+
+    ++mStats.stores;
+
+    return evict();
+}
+
+bool OutputCache::evict()
+{
+    removeStaleFiles(mDirectory, ".tmp", sStaleTempS);
+
+    if (not evictFiles(mDirectory, sEntrySuffix, mMaxBytes, mMaxEntries, mStats.evictions))
+    {
+        mLastError = string_format("Failed to list cache directory '%s': '%s'", mDirectory.c_str(), strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+bool OutputCache::evictFiles(const std::string& directory, const char* suffix, uint64_t maxBytes, size_t maxEntries, uint64_t& evictions)
+{
+    std::vector<CacheEntry> entries;
+
+    if (not list_entries(directory, suffix, entries))
+    {
+        return false;
+    }
+
+    uint64_t bytes = 0;
+
+    for (const CacheEntry& entry : entries)
+    {
+        bytes += entry.size;
+    }
+
+    if (bytes <= maxBytes && entries.size() <= maxEntries)
+    {
+        return true;
+    }
+
+    //// Least recently used first =============================================
+
+    std::stable_sort(entries.begin(), entries.end(), used_earlier);
+
+    size_t count = entries.size();
+
+    for (const CacheEntry& entry : entries)
+    {
+        if (bytes <= maxBytes && count <= maxEntries)
+        {
+            break;
+        }
+
+        if (remove(entry.path.c_str()) == 0)
+        {
+            bytes -= entry.size;
+            --count;
+            ++evictions;
+        }
+    }
+
+    return true;
+}
+
+void OutputCache::removeStaleFiles(const std::string& directory, const char* suffix, time_t maxAge)
+{
+    std::vector<CacheEntry> entries;
+
+    if (not list_entries(directory, suffix, entries))
+    {
+        return;
+    }
+
+    time_t now = time(nullptr);
+
+    for (const CacheEntry& entry : entries)
+    {
+        if (now - entry.used >= maxAge)
+        {
+            remove(entry.path.c_str());
+        }
+    }
+}
+
+bool OutputCache::usage(uint64_t& bytes, size_t& entries) const
+{
+    std::vector<CacheEntry> list;
+
+    if (not list_entries(mDirectory, sEntrySuffix, list))
+    {
+        mLastError = string_format("Failed to list cache directory '%s': '%s'", mDirectory.c_str(), strerror(errno));
+        return false;
+    }
+
+    bytes   = 0;
+    entries = list.size();
+
+    for (const CacheEntry& entry : list)
+    {
+        bytes += entry.size;
+    }
+
+    return true;
+}
+
+//// Statistics ================================================================
+
+bool OutputCache::loadStats(Stats& stats) const
+{
+    memset(&stats, 0x00, sizeof(stats));
+
+    std::string text;
+
+    if (not read_file(statsPath(), text))
+    {
+        // No stats yet
+
+        return true;
+    }
+
+    //// Each line is "<hits> <misses> <stores> <evictions>" of one run =======
+
+    for (StringRef line : StringSplit(text, '\n'))
+    {
+        std::string record = line.str();
+
+        unsigned long long counts[4] = { 0, 0, 0, 0 };
+
+        if (sscanf(record.c_str(), "%llu %llu %llu %llu", &counts[0], &counts[1], &counts[2], &counts[3]) != 4)
+        {
+            continue;
+        }
+
+        stats.hits      += counts[0];
+        stats.misses    += counts[1];
+        stats.stores    += counts[2];
+        stats.evictions += counts[3];
+    }
+
+    return true;
+}
+
+bool OutputCache::saveStats()
+{
+    mLastError.clear();
+
+    if (not isOpen() || (mStats.hits == 0 && mStats.misses == 0 && mStats.stores == 0 && mStats.evictions == 0))
+    {
+        return true;
+    }
+
+    // Runs append a record, as replacing the file would flush it to disk
+    // every time. The records are summed into one now and then.
+
+    if (file_size(statsPath()) >= sCompactStatsBytes)
+    {
+        Stats total;
+
+        loadStats(total);
+
+        total.hits      += mStats.hits;
+        total.misses    += mStats.misses;
+        total.stores    += mStats.stores;
+        total.evictions += mStats.evictions;
+
+        if (not replace_file(statsPath(), stats_record(total), mLastError))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        FILE* file = fopen(statsPath().c_str(), "ab");
+
+        if (file == nullptr)
+        {
+            mLastError = string_format("Failed to open cache stats '%s': '%s'", statsPath().c_str(), strerror(errno));
+            return false;
+        }
+
+        std::string text = stats_record(mStats);
+
+        fwrite(text.data(), 1, text.size(), file);
+        fclose(file);
+    }
+
+    memset(&mStats, 0x00, sizeof(mStats));
+
+    return true;
+}
+
+std::string OutputCache::lastError() const
+{
+    return mLastError;
+}
+
+//// Keys ======================================================================
+
+uint64_t OutputCache::toolKey(const char* exec)
+{
+    uint64_t key = hash_string(sCacheVersion);
+
+#ifdef _WIN32
+    const char* path = exec;
+#else
+    const char* path = "/proc/self/exe";
+    (void)exec;
+#endif
+
+    struct stat toolStat;
+
+    if (path != nullptr && stat(path, &toolStat) == 0)
+    {
+        key = hash_combine(key, (uint64_t)toolStat.st_size);
+        key = hash_combine(key, (uint64_t)toolStat.st_mtime);
+    }
+
+    return key;
+}
+
+std::string OutputCache::entryPath(uint64_t key) const
+{
+    return mDirectory + "/" + string_format("%08x%08x", (unsigned int)(key >> 32), (unsigned int)key) + sEntrySuffix;
+}
+
+std::string OutputCache::statsPath() const
+{
+    return mDirectory + "/stats";
+}
@@ -0,0 +1,80 @@
+#ifndef OUTPUTCACHE_H
+#define OUTPUTCACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <time.h>
+
+// Directory of rendered outputs keyed by the hash of everything they were
+// rendered from. Entries are plain files named after the key; their
+// modification time is the last use, and the least recently used ones are
+// removed once the directory grows past its limits. Each run appends its hit
+// and miss counts to a stats file in the same directory.
+
+class OutputCache
+{
+public:
+
+    struct Stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t stores;
+        uint64_t evictions;
+    };
+
+public:
+    OutputCache();
+
+    bool open(const std::string& directory);
+    bool isOpen() const;
+
+    void setLimits(uint64_t maxBytes, size_t maxEntries);
+
+    bool load(uint64_t key, std::string& text);
+    bool store(uint64_t key, const std::string& text);
+
+    // Adds this run's counts to the stats file
+
+    bool saveStats();
+
+    bool loadStats(Stats& stats) const;
+    bool usage(uint64_t& bytes, size_t& entries) const;
+
+    std::string lastError() const;
+
+    // Identity of the running tool, so a rebuilt exporter never reuses
+    // outputs of the old one
+
+    static uint64_t toolKey(const char* exec);
+
+    //// Directory limits ======================================================
+
+    // Removes the least recently used files ending in suffix until the rest
+    // fit the limits, counting them into evictions; false when the directory
+    // cannot be listed
+
+    static bool evictFiles(const std::string& directory, const char* suffix, uint64_t maxBytes, size_t maxEntries, uint64_t& evictions);
+
+    // Removes files ending in suffix not touched for maxAge seconds
+
+    static void removeStaleFiles(const std::string& directory, const char* suffix, time_t maxAge);
+
+private:
+
+    std::string mDirectory;
+
+    uint64_t    mMaxBytes;
+    size_t      mMaxEntries;
+
+    Stats       mStats;
+
+    mutable std::string mLastError;
+
+    std::string entryPath(uint64_t key) const;
+    std::string statsPath() const;
+
+    bool evict();
+};
+
+#endif // OUTPUTCACHE_H
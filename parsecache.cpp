@@ -0,0 +1,448 @@
+#include "parsecache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include "compiledproject.h"
+#include "outputcache.h"
+#include "utils.h"
+
+static const char sSlotMagic[4] = { 'P', 'J', 'S', 'C' };
+
+static const uint32_t sSlotVersion = 1;
+
+// Wait for another run's parse in steps of 5 ms for up to 5 s; a claim left
+// by a run that died is taken over after 30 s
+
+static const unsigned int sWaitStepUs  = 5000;
+static const unsigned int sWaitSteps   = 1000;
+static const time_t       sStaleClaimS = 30;
+
+// Projects parsed recently enough to be kept, most are a few hundred kB
+
+static const uint64_t sMaxBytes = 64ull * 1024 * 1024;
+static const size_t   sMaxSlots = 64;
+
+#ifdef _WIN32
+static const int sOpenFlags = O_RDONLY | O_BINARY;
+#else
+static const int sOpenFlags = O_RDONLY;
+#endif
+
+// Slot file header, the compiled project image follows it
+
+struct SlotHeader
+{
+    char     magic[4];
+    uint32_t version;
+    uint64_t pathHash;
+    uint64_t sourceSize;
+    uint64_t sourceTime;
+    uint64_t sourceHash;
+    uint32_t imageSize;
+    uint32_t reserved;
+};
+
+static bool make_directory(const std::string& path)
+{
+#ifdef _WIN32
+    int res = mkdir(path.c_str());
+#else
+    int res = mkdir(path.c_str(), 0700);
+#endif
+
+    return (res == 0 || errno == EEXIST);
+}
+
+// Slots are trusted as they are mapped, so the directory, which may have
+// been created by anyone in a shared location, must be a real directory of
+// this user that no one else can write to
+
+static bool is_private_directory(const std::string& path)
+{
+#ifdef _WIN32
+    (void)path;
+
+    return true;
+#else
+    struct stat dirStat;
+
+    if (lstat(path.c_str(), &dirStat) != 0)
+    {
+        return false;
+    }
+
+    return (S_ISDIR(dirStat.st_mode) &&
+            dirStat.st_uid == getuid() &&
+            (dirStat.st_mode & (S_IWGRP | S_IWOTH)) == 0);
+#endif
+}
+
+//// Mapped slot ===============================================================
+
+// Read-only view of a slot file, mapped where mmap is available
+
+class SlotFile
+{
+public:
+    SlotFile() : mData(nullptr), mSize(0)
+    {
+
+    }
+
+    ~SlotFile()
+    {
+#ifdef _WIN32
+        free(mData);
+#else
+        if (mData != nullptr)
+        {
+            munmap(mData, mSize);
+        }
+#endif
+    }
+
+    bool open(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), sOpenFlags);
+
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat slotStat;
+
+        if (fstat(fd, &slotStat) != 0 || (size_t)slotStat.st_size < sizeof(SlotHeader))
+        {
+            ::close(fd);
+            return false;
+        }
+
+        size_t size = (size_t)slotStat.st_size;
+
+#ifdef _WIN32
+        void* data = malloc(size);
+
+        if (data != nullptr && ::read(fd, data, (unsigned int)size) != (int)size)
+        {
+            free(data);
+            data = nullptr;
+        }
+#else
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (data == MAP_FAILED)
+        {
+            data = nullptr;
+        }
+#endif
+
+        ::close(fd);
+
+        mData = data;
+        mSize = size;
+
+        return (mData != nullptr);
+    }
+
+    const SlotHeader* header() const
+    {
+        return static_cast<const SlotHeader*>(mData);
+    }
+
+    const char* image() const
+    {
+        return static_cast<const char*>(mData) + sizeof(SlotHeader);
+    }
+
+    size_t size() const
+    {
+        return mSize;
+    }
+
+private:
+    void*  mData;
+    size_t mSize;
+};
+
+//// Parse cache ===============================================================
+
+ParseCache::ParseCache()
+{
+
+}
+
+ParseCache::~ParseCache()
+{
+    release();
+}
+
+bool ParseCache::open(const std::string& directory)
+{
+    mLastError.clear();
+    mDirectory.clear();
+
+    if (not make_directory(directory))
+    {
+        mLastError = string_format("Failed to create parse cache '%s': '%s'", directory.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (not is_private_directory(directory))
+    {
+        mLastError = string_format("Parse cache '%s' is not a directory owned and only writable by this user", directory.c_str());
+        return false;
+    }
+
+    mDirectory = directory;
+
+    return true;
+}
+
+bool ParseCache::isOpen() const
+{
+    return not mDirectory.empty();
+}
+
+std::string ParseCache::defaultDirectory()
+{
+#ifdef _WIN32
+    const char* temp = getenv("TEMP");
+
+    return std::string((temp != nullptr) ? temp : ".") + "/ccs-pjt-parser-parses";
+#else
+    struct stat shmStat;
+
+    const char* base = (stat("/dev/shm", &shmStat) == 0) ? "/dev/shm" : "/tmp";
+
+    return string_format("%s/ccs-pjt-parser-%u", base, (unsigned int)getuid());
+#endif
+}
+
+//// Lookup ====================================================================
+
+bool ParseCache::find(const std::string& path, ProjectSettings& settings)
+{
+    mLastError.clear();
+
+    struct stat sourceStat;
+
+    if (stat(path.c_str(), &sourceStat) != 0)
+    {
+        return false;
+    }
+
+    std::string entryPath = slotPath(path);
+
+    SlotFile slot;
+
+    if (not slot.open(entryPath))
+    {
+        return false;
+    }
+
+    const SlotHeader* header = slot.header();
+
+    if (memcmp(header->magic, sSlotMagic, sizeof(sSlotMagic)) != 0 ||
+        header->version    != sSlotVersion ||
+        header->pathHash   != hash_string(absolute_path(path)) ||
+        header->sourceSize != (uint64_t)sourceStat.st_size ||
+        header->sourceTime != (uint64_t)sourceStat.st_mtime ||
+        header->imageSize  != slot.size() - sizeof(SlotHeader))
+    {
+        return false;
+    }
+
+    //// Only a source that looks unchanged is read to compare its hash -------
+
+    std::string content;
+
+    if (not read_file(path, content) || header->sourceHash != hash_bytes(content.data(), content.size()))
+    {
+        return false;
+    }
+
+    CompiledProject image;
+
+    if (not image.attach(slot.image(), header->imageSize))
+    {
+        mLastError = image.lastError();
+        return false;
+    }
+
+    // Touched so eviction sees it as just used
+
+    utime(entryPath.c_str(), nullptr);
+
+    return image.toSettings(settings);
+}
+
+//// Publication ===============================================================
+
+bool ParseCache::publish(const std::string& path, const ProjectSettings& settings, const ProjectReader::SourceStamp& source)
+{
+    mLastError.clear();
+
+    std::string image;
+
+    CompiledProject::build(settings, image);
+
+    SlotHeader header;
+    memset(&header, 0x00, sizeof(header));
+
+    memcpy(header.magic, sSlotMagic, sizeof(sSlotMagic));
+
+    header.version    = sSlotVersion;
+    header.pathHash   = hash_string(absolute_path(path));
+    header.sourceSize = source.size;
+    header.sourceTime = source.time;
+    header.sourceHash = source.hash;
+    header.imageSize  = (uint32_t)image.size();
+
+    //// Written aside, then swapped in ========================================
+
+    std::string slot     = slotPath(path);
+    std::string tempPath = slot + string_format(".%u.tmp", (unsigned int)getpid());
+
+    FILE* file = fopen(tempPath.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        mLastError = string_format("Failed to open parse cache entry '%s': '%s'", tempPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    bool written = (fwrite(&header, sizeof(header), 1, file) == 1 &&
+                    fwrite(image.data(), 1, image.size(), file) == image.size());
+
+    if (fclose(file) != 0 || not written)
+    {
+        mLastError = string_format("Failed to write parse cache entry '%s'", tempPath.c_str());
+        remove(tempPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    remove(slot.c_str());
+#endif
+
+    if (rename(tempPath.c_str(), slot.c_str()) != 0)
+    {
+        mLastError = string_format("Failed to replace parse cache entry '%s': '%s'", slot.c_str(), strerror(errno));
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    evict();
+
+    return true;
+}
+
+void ParseCache::evict()
+{
+    // Left by runs that died while parsing or writing
+
+    OutputCache::removeStaleFiles(mDirectory, ".claim", sStaleClaimS);
+    OutputCache::removeStaleFiles(mDirectory, ".tmp", sStaleClaimS);
+
+    uint64_t evictions = 0;
+
+    OutputCache::evictFiles(mDirectory, ".slot", sMaxBytes, sMaxSlots, evictions);
+}
+
+//// Sharing one parse =========================================================
+
+bool ParseCache::claim(const std::string& path)
+{
+    release();
+
+    std::string claimPath = slotPath(path) + ".claim";
+
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        int fd = ::open(claimPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+
+        if (fd >= 0)
+        {
+            ::close(fd);
+            mClaimPath = claimPath;
+            return true;
+        }
+
+        //// Take over a claim of a run that never finished --------------------
+
+        struct stat claimStat;
+
+        if (errno != EEXIST || stat(claimPath.c_str(), &claimStat) != 0 ||
+            time(nullptr) - claimStat.st_mtime < sStaleClaimS)
+        {
+            break;
+        }
+
+        remove(claimPath.c_str());
+    }
+
+    return false;
+}
+
+void ParseCache::release()
+{
+    if (not mClaimPath.empty())
+    {
+        remove(mClaimPath.c_str());
+        mClaimPath.clear();
+    }
+}
+
+bool ParseCache::wait(const std::string& path, ProjectSettings& settings)
+{
+    std::string claimPath = slotPath(path) + ".claim";
+
+    for (unsigned int step = 0; step < sWaitSteps; ++step)
+    {
+        if (find(path, settings))
+        {
+            return true;
+        }
+
+        struct stat claimStat;
+
+        if (stat(claimPath.c_str(), &claimStat) != 0)
+        {
+            // Released, either published just now or failed
+
+            return find(path, settings);
+        }
+
+        usleep(sWaitStepUs);
+    }
+
+    return false;
+}
+
+std::string ParseCache::lastError() const
+{
+    return mLastError;
+}
+
+//// Keys ======================================================================
+
+std::string ParseCache::slotPath(const std::string& path) const
+{
+    uint64_t key = hash_string(absolute_path(path));
+
+    return mDirectory + "/" + string_format("%08x%08x", (unsigned int)(key >> 32), (unsigned int)key) + ".slot";
+}
@@ -0,0 +1,66 @@
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <stdint.h>
+#include <string>
+
+#include "projectreader.h"
+#include "projectsettings.h"
+
+// Parsed projects shared between concurrent runs, kept in a memory-backed
+// directory such as /dev/shm. Each project path has one slot file holding
+// the stamp of the source it was parsed from and a compiled project image,
+// which needs no fixing up wherever it is mapped. Lookups take no lock: a
+// slot is mapped and its stamp compared. A new parse is written aside and
+// renamed over the slot, so a reader sees the old or the new entry whole.
+// A slot's modification time is its last use; the least recently used ones
+// are removed once the directory grows past its limits.
+
+class ParseCache
+{
+public:
+    ParseCache();
+    ~ParseCache();
+
+    bool open(const std::string& directory);
+    bool isOpen() const;
+
+    static std::string defaultDirectory();
+
+    // Settings parsed from the current contents of the project
+
+    bool find(const std::string& path, ProjectSettings& settings);
+
+    // Stored under the stamp of the source the settings were parsed from, as
+    // taken by the reader with setHashSource()
+
+    bool publish(const std::string& path, const ProjectSettings& settings, const ProjectReader::SourceStamp& source);
+
+    //// Sharing one parse =====================================================
+
+    // The first run to miss claims the parse; the others wait for it to be
+    // published and fall back to parsing themselves after a timeout
+
+    bool claim(const std::string& path);
+    void release();
+
+    bool wait(const std::string& path, ProjectSettings& settings);
+
+    std::string lastError() const;
+
+private:
+
+    std::string mDirectory;
+    std::string mClaimPath;
+
+    std::string mLastError;
+
+    std::string slotPath(const std::string& path) const;
+
+    void evict();
+
+    ParseCache(const ParseCache& other);
+    ParseCache& operator=(const ParseCache& other);
+};
+
+#endif // PARSECACHE_H
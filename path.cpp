@@ -0,0 +1,196 @@
+#include "path.h"
+
+#include <ctype.h>
+#include <strings.h>
+
+#include "utils.h"
+
+static bool is_drive(StringRef segment)
+{
+    return (segment.length() == 2 && segment[1] == ':' && isalpha((unsigned char)segment[0]));
+}
+
+static bool is_variable(StringRef segment)
+{
+    return (segment.length() >= 2 && segment.front() == '%' && segment.back() == '%');
+}
+
+static bool is_project_dir(StringRef segment)
+{
+    static const StringRef projectDir("$(Proj_dir)");
+
+    return (segment.length() == projectDir.length() &&
+            strncasecmp(segment.data(), projectDir.data(), projectDir.length()) == 0);
+}
+
+//// Path ======================================================================
+
+Path::Path() : mBasename(0), mVariableLength(0), mRoot(Root::RELATIVE), mHash(hash_string(StringRef()))
+{
+
+}
+
+Path::Path(StringRef path) :
+    mPath(path.data(), path.length()),
+    mBasename(0),
+    mVariableLength(0),
+    mRoot(Root::RELATIVE),
+    mHash(0)
+{
+    for (char& c : mPath)
+    {
+        if (c == '\\')
+        {
+            c = '/';
+        }
+    }
+
+    mBasename = mPath.rfind('/');
+    mBasename = (mBasename == std::string::npos) ? 0 : mBasename + 1;
+
+    mObjectName = object_name(basename());
+
+    //// Canonical form, segment by segment ------------------------------------
+
+    bool leadingSlash = (not mPath.empty() && mPath[0] == '/');
+    bool unc          = (mPath.length() > 2 && mPath[0] == '/' && mPath[1] == '/' && mPath[2] != '/');
+
+    if (leadingSlash)
+    {
+        mRoot = Root::ABSOLUTE;
+        mCanonical = unc ? "//" : "/";
+    }
+
+    mCanonical.reserve(mPath.length());
+
+    // ".." removes the previous segment unless it belongs to this prefix: the
+    // root, a drive or variable, and leading ".."s
+
+    size_t fixed = mCanonical.length();
+
+    for (StringRef segment : StringSplit(mPath, '/'))
+    {
+        if (segment.empty() || segment == ".")
+        {
+            continue;
+        }
+
+        bool first = (mCanonical.length() == fixed && fixed == 0);
+
+        if (first && (is_drive(segment) || is_variable(segment) || is_project_dir(segment)))
+        {
+            if (is_drive(segment))
+            {
+                mRoot = Root::ABSOLUTE;
+            }
+            else if (is_variable(segment))
+            {
+                mRoot = Root::VARIABLE;
+                mVariableLength = segment.length() - 2;
+            }
+            else
+            {
+                mRoot = Root::PROJECT_DIR;
+            }
+
+            segment.appendTo(mCanonical);
+            fixed = mCanonical.length();
+
+            continue;
+        }
+
+        if (segment == "..")
+        {
+            if (mCanonical.length() > fixed)
+            {
+                size_t slash = mCanonical.rfind('/');
+                mCanonical.erase((slash == std::string::npos || slash < fixed) ? fixed : slash);
+                continue;
+            }
+
+            if (mRoot == Root::ABSOLUTE)
+            {
+                continue;
+            }
+        }
+
+        if (not mCanonical.empty() && mCanonical.back() != '/')
+        {
+            mCanonical.push_back('/');
+        }
+
+        segment.appendTo(mCanonical);
+
+        if (segment == "..")
+        {
+            fixed = mCanonical.length();
+        }
+    }
+
+    if (mCanonical.empty() && not mPath.empty())
+    {
+        mCanonical = ".";
+    }
+
+    mHash = hash_string(mCanonical);
+}
+
+bool Path::operator==(const Path& other) const
+{
+    return mHash == other.mHash && mCanonical == other.mCanonical;
+}
+
+bool Path::operator!=(const Path& other) const
+{
+    return !(*this == other);
+}
+
+bool Path::operator<(const Path& other) const
+{
+    return mCanonical < other.mCanonical;
+}
+
+const std::string& Path::str() const
+{
+    return mPath;
+}
+
+const std::string& Path::canonical() const
+{
+    return mCanonical;
+}
+
+Path::Root Path::root() const
+{
+    return mRoot;
+}
+
+StringRef Path::variable() const
+{
+    if (mRoot != Root::VARIABLE)
+    {
+        return StringRef();
+    }
+
+    return StringRef(mCanonical.data() + 1, mVariableLength);
+}
+
+StringRef Path::basename() const
+{
+    return StringRef(mPath.data() + mBasename, mPath.length() - mBasename);
+}
+
+const std::string& Path::objectName() const
+{
+    return mObjectName;
+}
+
+uint64_t Path::hash() const
+{
+    return mHash;
+}
+
+bool Path::empty() const
+{
+    return mPath.empty();
+}
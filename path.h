@@ -0,0 +1,60 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include <stdint.h>
+#include <string>
+
+#include "stringref.h"
+
+// Project path normalized once. str() is the path with '/' separators, as the
+// project files spell it and the exporters print it; canonical() also drops
+// "." segments, resolves ".." and repeated separators and identifies the file.
+// Basename, object name and hash are computed on construction.
+
+class Path
+{
+public:
+
+    enum class Root
+    {
+        RELATIVE,       // Relative to the project directory
+        PROJECT_DIR,    // $(Proj_dir)/...
+        VARIABLE,       // %VAR%/...
+        ABSOLUTE,       // /..., C:/... or //server/...
+    };
+
+public:
+    Path();
+    explicit Path(StringRef path);
+
+    bool operator==(const Path& other) const;
+    bool operator!=(const Path& other) const;
+    bool operator<(const Path& other) const;
+
+    const std::string& str() const;
+    const std::string& canonical() const;
+
+    Root        root() const;
+    StringRef   variable() const;
+
+    StringRef   basename() const;
+    const std::string& objectName() const;
+
+    uint64_t    hash() const;
+
+    bool        empty() const;
+
+private:
+
+    std::string mPath;
+    std::string mCanonical;
+    std::string mObjectName;
+
+    size_t      mBasename;
+    size_t      mVariableLength;
+
+    Root        mRoot;
+    uint64_t    mHash;
+};
+
+#endif // PATH_H
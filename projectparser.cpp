@@ -5,7 +5,9 @@
 
 #include "utils.h"
 
-ProjectParser::ProjectParser() : mSectionType(SectionType::NONE)
+ProjectParser::ProjectParser() :
+    mSectionType(SectionType::NONE),
+    mCurrentFileId(ProjectSettings::INVALID_FILE_ID)
 {
 
 }
@@ -39,18 +41,149 @@ ProjectSettings ProjectParser::projectSettings() const
     return mProjectSettings;
 }
 
+ProjectSettings ProjectParser::takeProjectSettings()
+{
+    ProjectSettings settings(std::move(mProjectSettings));
+
+    mProjectSettings.clear();
+
+    return settings;
+}
+
 //// ===========================================================================
-//// Sections ==================================================================
+//// Reparsing sections ========================================================
 //// ===========================================================================
 
-bool ProjectParser::isSection(const std::string& line) const
+ProjectParser::SectionTarget::SectionTarget() :
+    type(SectionType::NONE),
+    fileId(ProjectSettings::INVALID_FILE_ID)
+{
+
+}
+
+bool ProjectParser::SectionTarget::isGlobal() const
+{
+    return (type == SectionType::PROJECT_SETTINGS || type == SectionType::SOURCE_FILES);
+}
+
+uint64_t ProjectParser::SectionTarget::key() const
 {
-    if (line.length() < 2)
+    //// Files set the same options from source, library or command sections --
+
+    SectionType keyType = type;
+
+    if (type == SectionType::LIBRARY_SETTINGS || type == SectionType::COMMAND_SETTINGS)
     {
-        return false;
+        keyType = SectionType::SOURCE_SETTINGS;
     }
 
-    return (starts_with(line, "[") && ends_with(line, "]"));
+    uint64_t result = hash_combine(0, (uint64_t)keyType);
+
+    result = hash_string(config, result);
+    result = hash_combine(result, hash_string(tool));
+    result = hash_combine(result, fileId);
+
+    return result;
+}
+
+bool ProjectParser::isSectionHeader(const char* line, size_t length)
+{
+    return (length >= 2 && line[0] == '[' && line[length - 1] == ']');
+}
+
+void ProjectParser::setProjectSettings(ProjectSettings&& settings)
+{
+    mProjectSettings = std::move(settings);
+
+    mSectionType   = SectionType::NONE;
+    mCurrentFileId = ProjectSettings::INVALID_FILE_ID;
+}
+
+ProjectParser::SectionTarget ProjectParser::sectionTarget() const
+{
+    SectionTarget target;
+
+    target.type = mSectionType;
+
+    switch (mSectionType)
+    {
+    case SectionType::CONFIG_SETTINGS:
+        target.config = mCurrentConfig;
+        break;
+
+    case SectionType::TOOL_SETTINGS:
+        target.config = mCurrentConfig;
+        target.tool   = mCurrentTool;
+        break;
+
+    case SectionType::SOURCE_SETTINGS:
+    case SectionType::LIBRARY_SETTINGS:
+    case SectionType::COMMAND_SETTINGS:
+        target.config = mCurrentConfig;
+        target.fileId = mCurrentFileId;
+        break;
+
+    case SectionType::PROJECT_SETTINGS:
+    case SectionType::SOURCE_FILES:
+    case SectionType::NONE:
+        break;
+    }
+
+    return target;
+}
+
+void ProjectParser::clearTarget(const SectionTarget& target)
+{
+    switch (target.type)
+    {
+    case SectionType::CONFIG_SETTINGS:
+    {
+        ConfigSettings& config = mProjectSettings.config(target.config);
+
+        config.clearPreBuildSteps();
+        config.clearPostBuildSteps();
+        break;
+    }
+
+    case SectionType::TOOL_SETTINGS:
+    {
+        ConfigSettings& config = mProjectSettings.config(target.config);
+
+        if (strcasecmp(target.tool.c_str(), "Compiler") == 0)
+        {
+            config.clearCompilerOptions();
+        }
+        else if (strcasecmp(target.tool.c_str(), "Linker") == 0)
+        {
+            config.clearLinkerOptions();
+        }
+        else if (strcasecmp(target.tool.c_str(), "Archiver") == 0)
+        {
+            config.clearArchiverOptions();
+        }
+        break;
+    }
+
+    case SectionType::SOURCE_SETTINGS:
+    case SectionType::LIBRARY_SETTINGS:
+    case SectionType::COMMAND_SETTINGS:
+        mProjectSettings.config(target.config).clearFileOptions(target.fileId);
+        break;
+
+    case SectionType::PROJECT_SETTINGS:
+    case SectionType::SOURCE_FILES:
+    case SectionType::NONE:
+        break;
+    }
+}
+
+//// ===========================================================================
+//// Sections ==================================================================
+//// ===========================================================================
+
+bool ProjectParser::isSection(const std::string& line) const
+{
+    return isSectionHeader(line.c_str(), line.length());
 }
 
 bool ProjectParser::isConfigSettingsSection(const std::string& line, std::string& config) const
@@ -109,7 +242,20 @@ bool ProjectParser::getFileSettingsSection(const std::string& line, std::string&
         return false;
     }
 
-    if (file_set.find(fixpath(file)) == file_set.end())
+    //// Files match in any spelling and continue under the stored one ---------
+
+    unsigned int fileId = mProjectSettings.fileId(file);
+
+    if (fileId != ProjectSettings::INVALID_FILE_ID)
+    {
+        file = mProjectSettings.fileName(fileId);
+    }
+    else
+    {
+        file = fixpath(file);
+    }
+
+    if (file_set.find(file) == file_set.end())
     {
         return false;
     }
@@ -176,6 +322,13 @@ bool ProjectParser::parseSection(const std::string& line)
         mSectionType = SectionType::NONE;
     }
 
+    if (mSectionType == SectionType::SOURCE_SETTINGS  ||
+        mSectionType == SectionType::LIBRARY_SETTINGS ||
+        mSectionType == SectionType::COMMAND_SETTINGS)
+    {
+        mCurrentFileId = mProjectSettings.fileId(mCurrentFile);
+    }
+
     return true;
 }
 
@@ -297,7 +450,7 @@ bool ProjectParser::parseSourceFile(const std::string& key, const std::string& v
 
     if (strcasecmp(key.c_str(), "Source") == 0)
     {
-        mProjectSettings.addSource(fixpath(value).c_str());
+        mProjectSettings.addSource(value.c_str());
     }
 
     //// Unknown ===============================================================
@@ -354,21 +507,28 @@ bool ProjectParser::parseToolSettings(const std::string& key, const std::string&
 
     if (strcasecmp(key.c_str(), "Options") == 0)
     {
-        stringlist options = split(value, ' ');
+        ConfigSettings& config = mProjectSettings.config(mCurrentConfig);
+
+        bool compiler = (strcasecmp(mCurrentTool.c_str(), "Compiler") == 0);
+        bool linker   = (strcasecmp(mCurrentTool.c_str(), "Linker") == 0);
+        bool archiver = (strcasecmp(mCurrentTool.c_str(), "Archiver") == 0);
 
-        for (const std::string& option : options)
+        OptionLexer lexer(value);
+        OptionToken option;
+
+        while (lexer.next(option))
         {
-            if (strcasecmp(mCurrentTool.c_str(), "Compiler") == 0)
+            if (compiler)
             {
-                mProjectSettings.config(mCurrentConfig).addCompilerOption(option.c_str());
+                config.addCompilerOption(option);
             }
-            else if (strcasecmp(mCurrentTool.c_str(), "Linker") == 0)
+            else if (linker)
             {
-                mProjectSettings.config(mCurrentConfig).addLinkerOption(option.c_str());
+                config.addLinkerOption(option);
             }
-            else if (strcasecmp(mCurrentTool.c_str(), "Archiver") == 0)
+            else if (archiver)
             {
-                mProjectSettings.config(mCurrentConfig).addArchiverOption(option.c_str());
+                config.addArchiverOption(option);
             }
             else
             {
@@ -402,23 +562,30 @@ bool ProjectParser::parseSourceSettings(const std::string& key, const std::strin
 
         if (starts_with(value, "\"Compiler\" "))
         {
-            std::string opt_add;
+            StringRef   list;
+            OptionToken option;
 
-            if (between(value, "+{", "}", opt_add))
+            if (between(value, "+{", "}", list))
             {
-                for (const std::string& option : split(opt_add, ' '))
+                FileOptions& file = mProjectSettings.config(mCurrentConfig).file(mCurrentFileId);
+
+                OptionLexer lexer(list.begin(), list.end());
+
+                while (lexer.next(option))
                 {
-                    mProjectSettings.config(mCurrentConfig).file(mCurrentFile).addOptionAdded(option);
+                    file.addOptionAdded(option.text());
                 }
             }
 
-            std::string opt_del;
-
-            if (between(value, "-{", "}", opt_del))
+            if (between(value, "-{", "}", list))
             {
-                for (const std::string& option : split(opt_del, ' '))
+                FileOptions& file = mProjectSettings.config(mCurrentConfig).file(mCurrentFileId);
+
+                OptionLexer lexer(list.begin(), list.end());
+
+                while (lexer.next(option))
                 {
-                    mProjectSettings.config(mCurrentConfig).file(mCurrentFile).addOptionRemoved(option);
+                    file.addOptionRemoved(option.text());
                 }
             }
         }
@@ -461,7 +628,7 @@ bool ProjectParser::parseSourceSettings(const std::string& key, const std::strin
             return false;
         }
 
-        mProjectSettings.config(mCurrentConfig).file(mCurrentFile).setLinkOrder(order);
+        mProjectSettings.config(mCurrentConfig).file(mCurrentFileId).setLinkOrder(order);
     }
 
     //// Run condition =========================================================
@@ -475,7 +642,7 @@ bool ProjectParser::parseSourceSettings(const std::string& key, const std::strin
             if (BuildStep::buildConditionString(i, true) == value)
             {
                 found = true;
-                mProjectSettings.config(mCurrentConfig).file(mCurrentFile).setBuildCondition(i);
+                mProjectSettings.config(mCurrentConfig).file(mCurrentFileId).setBuildCondition(i);
                 break;
             }
         }
@@ -494,14 +661,14 @@ bool ProjectParser::parseSourceSettings(const std::string& key, const std::strin
 
     else if (strcasecmp(key.c_str(), "PreBuildCmd") == 0)
     {
-        mProjectSettings.config(mCurrentConfig).file(mCurrentFile).preBuildSteps().add(BuildStep::fromString(value));
+        mProjectSettings.config(mCurrentConfig).file(mCurrentFileId).preBuildSteps().add(BuildStep::fromString(value));
     }
 
     //// Post build step =======================================================
 
     else if (strcasecmp(key.c_str(), "PostBuildCmd") == 0)
     {
-        mProjectSettings.config(mCurrentConfig).file(mCurrentFile).postBuildSteps().add(BuildStep::fromString(value));
+        mProjectSettings.config(mCurrentConfig).file(mCurrentFileId).postBuildSteps().add(BuildStep::fromString(value));
     }
 
     //// Exclude from build ====================================================
@@ -510,11 +677,11 @@ bool ProjectParser::parseSourceSettings(const std::string& key, const std::strin
     {
         if (strcasecmp(value.c_str(), "true") == 0)
         {
-            mProjectSettings.config(mCurrentConfig).file(mCurrentFile).setExcludeFromBuild(true);
+            mProjectSettings.config(mCurrentConfig).file(mCurrentFileId).setExcludeFromBuild(true);
         }
         else if (strcasecmp(value.c_str(), "false") == 0)
         {
-            mProjectSettings.config(mCurrentConfig).file(mCurrentFile).setExcludeFromBuild(false);
+            mProjectSettings.config(mCurrentConfig).file(mCurrentFileId).setExcludeFromBuild(false);
         }
         else
         {
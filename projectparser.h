@@ -19,6 +19,27 @@ public:
         COMMAND_SETTINGS
     };
 
+    // What the lines of a section set: the steps of a configuration, the
+    // options of one of its tools or the options of one of its files
+
+    struct SectionTarget
+    {
+        SectionTarget();
+
+        SectionType  type;
+        std::string  config;
+        std::string  tool;
+        unsigned int fileId;
+
+        // Project and file list sections shape everything parsed after them
+
+        bool isGlobal() const;
+
+        // Equal for sections with the same target
+
+        uint64_t key() const;
+    };
+
 public:
     ProjectParser();
 
@@ -26,9 +47,24 @@ public:
 
     void clear();
 
+    //// Reparsing sections ====================================================
+
+    static bool isSectionHeader(const char* line, size_t length);
+
+    // Continues from settings parsed before, with no current section
+
+    void setProjectSettings(ProjectSettings&& settings);
+
+    SectionTarget sectionTarget() const;
+
+    // Resets what the sections of the target set, before they are parsed again
+
+    void clearTarget(const SectionTarget& target);
+
     std::string lastError() const;
 
     ProjectSettings projectSettings() const;
+    ProjectSettings takeProjectSettings();
 
 private:
 
@@ -38,6 +74,7 @@ private:
     std::string     mCurrentConfig;
     std::string     mCurrentTool;
     std::string     mCurrentFile;
+    unsigned int    mCurrentFileId;
 
     std::string     mLastError;
 
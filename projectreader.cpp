@@ -4,6 +4,7 @@
 #include <string.h>
 #include <sys/stat.h>
 
+#include "encoding.h"
 #include "utils.h"
 
 static char *strchrnull(char *string, int c)
@@ -18,8 +19,15 @@ static char *strchrnull(char *string, int c)
     return result;
 }
 
-ProjectReader::ProjectReader(const char* path)
+static const size_t sNoSection = (size_t)-1;
+
+ProjectReader::ProjectReader(const char* path) :
+    mHashSource(false),
+    mIndexed(false),
+    mChangedAll(true)
 {
+    memset(&mSourceStamp, 0x00, sizeof(mSourceStamp));
+
     if (path != nullptr)
     {
         mPath = path;
@@ -28,9 +36,10 @@ ProjectReader::ProjectReader(const char* path)
 
 bool ProjectReader::read(const char* path)
 {
-    if (path != nullptr)
+    if (path != nullptr && mPath != path)
     {
-        mPath = path;
+        mPath    = path;
+        mIndexed = false;
     }
 
     mLastError.clear();
@@ -45,11 +54,14 @@ bool ProjectReader::read(const char* path)
 
     //// Read project file =====================================================
 
-    size_t projectSize   = 0;
-    char*  projectBuffer = nullptr;
+    // Text is kept with two trailing NULs, the line loop reads past the last
+    // terminator
+
+    std::string  projectText;
+    TextEncoding projectEncoding = TextEncoding::ASCII;
 
     {
-        FILE* projectFile = fopen(mPath.c_str(), "r");
+        FILE* projectFile = fopen(mPath.c_str(), "rb");
         if (projectFile == nullptr)
         {
             mLastError = string_format("Failed to open project '%s': '%s'", mPath.c_str(), strerror(errno));
@@ -65,34 +77,62 @@ bool ProjectReader::read(const char* path)
             return false;
         }
 
-        projectBuffer = new char[projectStat.st_size + 2];
-        if (projectBuffer == nullptr)
+        projectText.resize((size_t)projectStat.st_size);
+
+        size_t projectSize = projectText.empty() ? 0 : fread(&projectText[0], 1, projectText.size(), projectFile);
+
+        fclose(projectFile);
+
+        projectText.resize(projectSize);
+
+        mSourceStamp.size = (uint64_t)projectStat.st_size;
+        mSourceStamp.time = (uint64_t)projectStat.st_mtime;
+        mSourceStamp.hash = mHashSource ? hash_bytes(projectText.data(), projectText.size()) : 0;
+
+        if (CompiledProject::isImage(projectText.data(), projectText.size()))
         {
-            mLastError = "Failed to allocate memory";
-            fclose(projectFile);
-            return false;
+            projectText.clear();
+
+            mIndexed    = false;
+            mChangedAll = true;
+
+            return (readCompiled() && mCompiled.toSettings(mSettings));
         }
 
-        memset(projectBuffer, 0x00, (size_t)(projectStat.st_size + 2));
+        //// Transcode once -----------------------------------------------------
 
-        projectSize = fread(projectBuffer, 1, (size_t)projectStat.st_size, projectFile);
+        projectEncoding = detect_encoding(projectText.data(), projectText.size());
 
-        fclose(projectFile);
+        if (has_utf8_bom(projectText.data(), projectText.size()))
+        {
+            projectText.erase(0, 3);
+        }
+        else if (projectEncoding == TextEncoding::CP1251)
+        {
+            std::string utf8;
+            cp1251_to_utf8(projectText.data(), projectText.size(), utf8);
+            projectText.swap(utf8);
+        }
+
+        projectSize = projectText.size();
 
-        removeLineFeeds(projectBuffer, projectSize);
+        projectText.append(2, '\0');
 
-        char* cr = strchr(projectBuffer, '\r');
+        removeLineFeeds(&projectText[0], projectSize);
 
-        if (cr != nullptr)
+        if (memchr(projectText.data(), '\r', projectSize) != nullptr)
         {
             mLastError = "Failed to remove CR";
             return false;
         }
     }
 
-    //// Parse project =========================================================
+    char* projectBuffer = &projectText[0];
 
-    ProjectParser parser;
+    //// Split into sections ===================================================
+
+    std::vector<char*>   lines;
+    std::vector<Section> sections;
 
     char* nextLine = nullptr;
 
@@ -127,33 +167,383 @@ bool ProjectReader::read(const char* path)
 
         //// Check for new section ---------------------------------------------
 
-        if (not parser.parseLine(currentLine))
+        bool header = ProjectParser::isSectionHeader(currentLine, lineLength);
+
+        if (header || sections.empty())
         {
-            mLastError = parser.lastError().c_str();
-            return false;
+            Section section;
+
+            section.firstLine = lines.size();
+            section.lineCount = 0;
+            section.hasHeader = header;
+            section.hash      = 0;
+            section.next      = sNoSection;
+
+            sections.push_back(section);
         }
 
+        // The terminator keeps line boundaries apart in the hash
+
+        Section& section = sections.back();
+
+        section.hash = hash_bytes(currentLine, lineLength + 1, section.hash);
+        ++section.lineCount;
+
+        lines.push_back(currentLine);
+
         //// -------------------------------------------------------------------
 
     }
 
-    mSettings = parser.projectSettings();
+    //// Parse project =========================================================
+
+    ProjectParser parser;
+    SectionIndex  index;
+
+    std::set<unsigned int> changedFileIds;
+
+    index.globalHash = (uint64_t)projectEncoding;
+
+    mChangedAll = true;
+    mChangedConfigs.clear();
+    mChangedFiles.clear();
+
+    if (mIndexed)
+    {
+        //// Reparse changed sections ------------------------------------------
+
+        // Headers resolve against the previous file list, which holds as long
+        // as the global sections are the same
+
+        mIndexed = false;
+
+        parser.setProjectSettings(std::move(mSettings));
+        mSettings.clear();
+
+        indexSections(parser, lines, sections, index, false);
+
+        if (index.globalHash == mIndex.globalHash && not dropsConfig(index))
+        {
+            if (not parseChanged(parser, lines, sections, index, changedFileIds))
+            {
+                mLastError = parser.lastError();
+                return false;
+            }
+
+            mChangedAll = false;
+        }
+        else
+        {
+            parser.setProjectSettings(ProjectSettings());
+
+            index = SectionIndex();
+            index.globalHash = (uint64_t)projectEncoding;
+
+            for (Section& section : sections)
+            {
+                section.next = sNoSection;
+            }
+        }
+    }
+
+    if (mChangedAll && not indexSections(parser, lines, sections, index, true))
+    {
+        mLastError = parser.lastError();
+        return false;
+    }
+
+    mSettings = parser.takeProjectSettings();
+    mSettings.setEncoding(projectEncoding);
+    mSettings.freeze();
+
+    for (unsigned int fileId : changedFileIds)
+    {
+        mChangedFiles.insert(mSettings.fileName(fileId));
+    }
+
+    mIndex   = std::move(index);
+    mIndexed = true;
 
     //// =======================================================================
 
     return true;
 }
 
+bool ProjectReader::readCompiled(const char* path)
+{
+    if (path != nullptr)
+    {
+        mPath = path;
+    }
+
+    mLastError.clear();
+
+    if (mPath.empty())
+    {
+        mLastError = "Missing project path argument";
+        return false;
+    }
+
+    if (not mCompiled.open(mPath))
+    {
+        mLastError = mCompiled.lastError();
+        return false;
+    }
+
+    return true;
+}
+
+const CompiledProject& ProjectReader::compiledProject() const
+{
+    return mCompiled;
+}
+
 std::string ProjectReader::lastError() const
 {
     return mLastError;
 }
 
+void ProjectReader::setHashSource(bool hashSource)
+{
+    mHashSource = hashSource;
+}
+
+const ProjectReader::SourceStamp& ProjectReader::sourceStamp() const
+{
+    return mSourceStamp;
+}
+
 ProjectSettings ProjectReader::projectSettings() const
 {
     return mSettings;
 }
 
+ProjectSettings ProjectReader::takeProjectSettings()
+{
+    ProjectSettings settings(std::move(mSettings));
+
+    mSettings.clear();
+
+    mIndexed = false;
+
+    return settings;
+}
+
+//// Changes since the previous read ===========================================
+
+bool ProjectReader::changedAll() const
+{
+    return mChangedAll;
+}
+
+stringset ProjectReader::changedConfigs() const
+{
+    return mChangedConfigs;
+}
+
+stringset ProjectReader::changedFiles() const
+{
+    return mChangedFiles;
+}
+
+//// Section index =============================================================
+
+ProjectReader::SectionEntry::SectionEntry() :
+    hash(0),
+    firstSection(sNoSection),
+    lastSection(sNoSection)
+{
+
+}
+
+ProjectReader::SectionIndex::SectionIndex() :
+    globalHash(0)
+{
+
+}
+
+bool ProjectReader::indexSections(ProjectParser& parser, const std::vector<char*>& lines, std::vector<Section>& sections, SectionIndex& index, bool parseData)
+{
+    ProjectParser::SectionTarget parsed;
+
+    for (size_t i = 0; i < sections.size(); ++i)
+    {
+        Section& section = sections[i];
+
+        const ProjectParser::SectionTarget* target = &parsed;
+        uint64_t                            key    = 0;
+
+        //// Resolve what the section sets -------------------------------------
+
+        uint64_t headerHash = section.hasHeader ? hash_string(lines[section.firstLine]) : 0;
+
+        FlatMap<uint64_t, uint64_t>::const_iterator known = mIndex.headers.end();
+
+        if (not parseData && section.hasHeader)
+        {
+            known = mIndex.headers.find(headerHash);
+        }
+
+        if (known != mIndex.headers.end())
+        {
+            key    = known->second;
+            target = &mIndex.entries[mIndex.targets.at(key)].target;
+        }
+        else
+        {
+            if (parseData)
+            {
+                if (not parseSection(parser, lines, section))
+                {
+                    return false;
+                }
+            }
+            else if (section.hasHeader)
+            {
+                parser.parseLine(lines[section.firstLine]);
+            }
+
+            parsed = parser.sectionTarget();
+            key    = parsed.key();
+        }
+
+        if (section.hasHeader)
+        {
+            index.headers[headerHash] = key;
+        }
+
+        //// Group sections by what they set -----------------------------------
+
+        if (target->isGlobal())
+        {
+            index.globalHash = hash_combine(index.globalHash, section.hash);
+        }
+
+        FlatMap<uint64_t, size_t>::const_iterator found = index.targets.find(key);
+
+        size_t entryIndex = 0;
+
+        if (found != index.targets.end())
+        {
+            entryIndex = found->second;
+            sections[index.entries[entryIndex].lastSection].next = i;
+        }
+        else
+        {
+            entryIndex = index.entries.size();
+            index.targets[key] = entryIndex;
+
+            index.entries.push_back(SectionEntry());
+            index.entries.back().target       = *target;
+            index.entries.back().firstSection = i;
+        }
+
+        SectionEntry& entry = index.entries[entryIndex];
+
+        entry.hash        = hash_combine(entry.hash, section.hash);
+        entry.lastSection = i;
+    }
+
+    index.targets.freeze();
+    index.headers.freeze();
+
+    return true;
+}
+
+bool ProjectReader::parseChanged(ProjectParser& parser, const std::vector<char*>& lines, const std::vector<Section>& sections, const SectionIndex& index, std::set<unsigned int>& changedFileIds)
+{
+    std::vector<const ProjectParser::SectionTarget*> changed;
+
+    //// Targets with new or edited sections -----------------------------------
+
+    for (const SectionEntry& entry : index.entries)
+    {
+        FlatMap<uint64_t, size_t>::const_iterator previous = mIndex.targets.find(entry.target.key());
+
+        if (previous != mIndex.targets.end() && mIndex.entries[previous->second].hash == entry.hash)
+        {
+            continue;
+        }
+
+        parser.clearTarget(entry.target);
+
+        for (size_t i = entry.firstSection; i != sNoSection; i = sections[i].next)
+        {
+            if (not parseSection(parser, lines, sections[i]))
+            {
+                return false;
+            }
+        }
+
+        changed.push_back(&entry.target);
+    }
+
+    //// Targets whose sections were all removed -------------------------------
+
+    for (const SectionEntry& entry : mIndex.entries)
+    {
+        if (index.targets.count(entry.target.key()) == 0)
+        {
+            parser.clearTarget(entry.target);
+
+            changed.push_back(&entry.target);
+        }
+    }
+
+    //// -----------------------------------------------------------------------
+
+    for (const ProjectParser::SectionTarget* target : changed)
+    {
+        if (not target->config.empty())
+        {
+            mChangedConfigs.insert(target->config);
+        }
+
+        if (target->fileId != ProjectSettings::INVALID_FILE_ID)
+        {
+            changedFileIds.insert(target->fileId);
+        }
+    }
+
+    return true;
+}
+
+bool ProjectReader::parseSection(ProjectParser& parser, const std::vector<char*>& lines, const Section& section)
+{
+    for (size_t line = 0; line < section.lineCount; ++line)
+    {
+        if (not parser.parseLine(lines[section.firstLine + line]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Configurations only named in section headers exist as long as one of their
+// sections does, so losing the last one needs a full parse
+
+bool ProjectReader::dropsConfig(const SectionIndex& index) const
+{
+    stringset configs;
+
+    for (const SectionEntry& entry : index.entries)
+    {
+        configs.insert(entry.target.config);
+    }
+
+    for (const SectionEntry& entry : mIndex.entries)
+    {
+        if (configs.count(entry.target.config) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void ProjectReader::removeLineFeeds(char* string, size_t& length)
 {
     size_t lineFeeds = 0;
@@ -1,7 +1,11 @@
 ﻿#ifndef PROJECTREADER_H
 #define PROJECTREADER_H
 
+#include <set>
 #include <string>
+#include <vector>
+#include "compiledproject.h"
+#include "flatmap.h"
 #include "projectsettings.h"
 #include "projectparser.h"
 
@@ -10,18 +14,109 @@ class ProjectReader
 public:
     ProjectReader(const char* path = nullptr);
 
+    // Reads a .pjt file, or rebuilds the settings from a compiled project
+
     bool read(const char* path = nullptr);
 
+    // Maps a compiled project (.pjtc) without building settings, the image
+    // stays mapped until the next read
+
+    bool readCompiled(const char* path = nullptr);
+
+    const CompiledProject& compiledProject() const;
+
     std::string lastError() const;
 
     ProjectSettings projectSettings() const;
+    ProjectSettings takeProjectSettings();
+
+    //// Source stamp ==========================================================
+
+    // Size and modification time of the file the last read parsed, and the
+    // hash of its bytes when asked for before the read
+
+    struct SourceStamp
+    {
+        uint64_t size;
+        uint64_t time;
+        uint64_t hash;
+    };
+
+    void setHashSource(bool hashSource);
+
+    const SourceStamp& sourceStamp() const;
+
+    //// Changes since the previous read =======================================
+
+    // Reading the same project again parses only the sections whose content
+    // changed and patches the kept settings in place. Everything counts as
+    // changed on a first read, after the settings were taken, or when the
+    // project settings, the file list or the encoding changed; the sets are
+    // left empty then
+
+    bool      changedAll() const;
+    stringset changedConfigs() const;
+    stringset changedFiles() const;
 
 private:
 
+    // Non-empty lines of a section, starting with its header unless they come
+    // before the first one
+
+    struct Section
+    {
+        size_t   firstLine;
+        size_t   lineCount;
+        bool     hasHeader;
+        uint64_t hash;
+        size_t   next;          // Next section with the same target
+    };
+
+    struct SectionEntry
+    {
+        SectionEntry();
+
+        ProjectParser::SectionTarget target;
+        uint64_t                     hash;
+
+        size_t   firstSection;  // Sections of the read that built the entry
+        size_t   lastSection;
+    };
+
+    // Entries are found by target key; a re-read takes the target of a header
+    // seen before from its hash instead of parsing the header
+
+    struct SectionIndex
+    {
+        SectionIndex();
+
+        uint64_t                    globalHash;
+        std::vector<SectionEntry>   entries;
+        FlatMap<uint64_t, size_t>   targets;
+        FlatMap<uint64_t, uint64_t> headers;
+    };
+
     ProjectSettings mSettings;
+    CompiledProject mCompiled;
     std::string     mPath;
     std::string     mLastError;
 
+    bool            mHashSource;
+    SourceStamp     mSourceStamp;
+
+    SectionIndex    mIndex;
+    bool            mIndexed;
+
+    bool            mChangedAll;
+    stringset       mChangedConfigs;
+    stringset       mChangedFiles;
+
+    bool indexSections(ProjectParser& parser, const std::vector<char*>& lines, std::vector<Section>& sections, SectionIndex& index, bool parseData);
+    bool parseChanged(ProjectParser& parser, const std::vector<char*>& lines, const std::vector<Section>& sections, const SectionIndex& index, std::set<unsigned int>& changedFileIds);
+    bool parseSection(ProjectParser& parser, const std::vector<char*>& lines, const Section& section);
+
+    bool dropsConfig(const SectionIndex& index) const;
+
     static void removeLineFeeds(char* string, size_t& length);
 };
 
@@ -2,9 +2,17 @@
 
 #include <string.h>
 
+#include "modelversion.h"
 #include "utils.h"
 
-ProjectSettings::ProjectSettings() : mType(Type::UNKNOWN), mToolFlags(0x00000000u)
+ProjectSettings::ProjectSettings() :
+    mType(Type::UNKNOWN),
+    mToolFlags(0x00000000u),
+    mEncoding(TextEncoding::ASCII),
+    mHash(0),
+    mHashValid(false),
+    mConfigsHash(0),
+    mConfigsVersion(ModelVersion::NONE)
 {
 
 }
@@ -14,11 +22,39 @@ ProjectSettings::ProjectSettings(const ProjectSettings& other) :
     mCpuFamily(other.mCpuFamily),
     mProjectDir(other.mProjectDir),
     mToolFlags(other.mToolFlags),
+    mEncoding(other.mEncoding),
     mConfigs(other.mConfigs),
     mTools(other.mTools),
     mSources(other.mSources),
     mCommands(other.mCommands),
-    mLibraries(other.mLibraries)
+    mLibraries(other.mLibraries),
+    mFilePaths(other.mFilePaths),
+    mFileIds(other.mFileIds),
+    mHash(other.mHash),
+    mHashValid(other.mHashValid),
+    mConfigsHash(other.mConfigsHash),
+    mConfigsVersion(other.mConfigsVersion)
+{
+
+}
+
+ProjectSettings::ProjectSettings(ProjectSettings&& other) noexcept :
+    mType(other.mType),
+    mCpuFamily(std::move(other.mCpuFamily)),
+    mProjectDir(std::move(other.mProjectDir)),
+    mToolFlags(other.mToolFlags),
+    mEncoding(other.mEncoding),
+    mConfigs(std::move(other.mConfigs)),
+    mTools(std::move(other.mTools)),
+    mSources(std::move(other.mSources)),
+    mCommands(std::move(other.mCommands)),
+    mLibraries(std::move(other.mLibraries)),
+    mFilePaths(std::move(other.mFilePaths)),
+    mFileIds(std::move(other.mFileIds)),
+    mHash(other.mHash),
+    mHashValid(other.mHashValid),
+    mConfigsHash(other.mConfigsHash),
+    mConfigsVersion(other.mConfigsVersion)
 {
 
 }
@@ -31,6 +67,7 @@ ProjectSettings&ProjectSettings::operator=(const ProjectSettings& other)
     this->mProjectDir = other.mProjectDir;
 
     this->mToolFlags  = other.mToolFlags;
+    this->mEncoding   = other.mEncoding;
 
     this->mConfigs    = other.mConfigs;
 
@@ -39,11 +76,54 @@ ProjectSettings&ProjectSettings::operator=(const ProjectSettings& other)
     this->mCommands   = other.mCommands;
     this->mLibraries  = other.mLibraries;
 
+    this->mFilePaths  = other.mFilePaths;
+    this->mFileIds    = other.mFileIds;
+
+    this->mHash       = other.mHash;
+    this->mHashValid  = other.mHashValid;
+
+    this->mConfigsHash    = other.mConfigsHash;
+    this->mConfigsVersion = other.mConfigsVersion;
+
+    return *this;
+}
+
+ProjectSettings& ProjectSettings::operator=(ProjectSettings&& other) noexcept
+{
+    this->mType       = other.mType;
+
+    this->mCpuFamily  = std::move(other.mCpuFamily);
+    this->mProjectDir = std::move(other.mProjectDir);
+
+    this->mToolFlags  = other.mToolFlags;
+    this->mEncoding   = other.mEncoding;
+
+    this->mConfigs    = std::move(other.mConfigs);
+
+    this->mTools      = std::move(other.mTools);
+    this->mSources    = std::move(other.mSources);
+    this->mCommands   = std::move(other.mCommands);
+    this->mLibraries  = std::move(other.mLibraries);
+
+    this->mFilePaths  = std::move(other.mFilePaths);
+    this->mFileIds    = std::move(other.mFileIds);
+
+    this->mHash       = other.mHash;
+    this->mHashValid  = other.mHashValid;
+
+    this->mConfigsHash    = other.mConfigsHash;
+    this->mConfigsVersion = other.mConfigsVersion;
+
     return *this;
 }
 
 bool ProjectSettings::operator==(const ProjectSettings& other) const
 {
+    if (this->hash() != other.hash())
+    {
+        return false;
+    }
+
     if (this->mType != other.mType)
     {
         return false;
@@ -64,6 +144,11 @@ bool ProjectSettings::operator==(const ProjectSettings& other) const
         return false;
     }
 
+    if (this->mEncoding != other.mEncoding)
+    {
+        return false;
+    }
+
     if (this->mConfigs != other.mConfigs)
     {
         return false;
@@ -89,6 +174,11 @@ bool ProjectSettings::operator==(const ProjectSettings& other) const
         return false;
     }
 
+    if (this->mFilePaths != other.mFilePaths)
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -99,6 +189,9 @@ bool ProjectSettings::operator!=(const ProjectSettings& other) const
 
 void ProjectSettings::clear()
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mType = Type::UNKNOWN;
 
     mCpuFamily.clear();
@@ -106,12 +199,17 @@ void ProjectSettings::clear()
 
     mToolFlags = 0x00000000u;
 
+    mEncoding = TextEncoding::ASCII;
+
     mConfigs.clear();
 
     mTools.clear();
     mSources.clear();
     mCommands.clear();
     mLibraries.clear();
+
+    mFilePaths.clear();
+    mFileIds.clear();
 }
 
 //// Global settings ===========================================================
@@ -125,6 +223,9 @@ ProjectSettings::Type ProjectSettings::projectType() const
 
 void ProjectSettings::setProjectType(const ProjectSettings::Type& projectType)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mType = projectType;
 }
 
@@ -154,6 +255,9 @@ std::string ProjectSettings::cpuFamily() const
 
 void ProjectSettings::setCpuFamily(const char* cpuFamily)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mCpuFamily = cpuFamily;
 }
 
@@ -166,9 +270,27 @@ std::string ProjectSettings::projectDir() const
 
 void ProjectSettings::setProjectDir(const char* projectDir)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mProjectDir = projectDir;
 }
 
+//// Source encoding -----------------------------------------------------------
+
+TextEncoding ProjectSettings::encoding() const
+{
+    return mEncoding;
+}
+
+void ProjectSettings::setEncoding(TextEncoding encoding)
+{
+    mHashValid = false;
+    ModelVersion::bump();
+
+    mEncoding = encoding;
+}
+
 //// Available tools -----------------------------------------------------------
 
 uint32_t ProjectSettings::toolFlags() const
@@ -188,6 +310,9 @@ cstringset& ProjectSettings::c_tools() const
 
 void ProjectSettings::addTool(const char* tool)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     if (strcasecmp(tool, "Compiler") == 0)
     {
         mToolFlags |= TOOL_COMPILER;
@@ -210,6 +335,9 @@ void ProjectSettings::addTool(const char* tool)
 
 void ProjectSettings::removeTool(const char* tool)
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     if (strcasecmp(tool, "Compiler") == 0)
     {
         mToolFlags &= (uint32_t)~TOOL_COMPILER;
@@ -232,6 +360,9 @@ void ProjectSettings::removeTool(const char* tool)
 
 void ProjectSettings::clearTools()
 {
+    mHashValid = false;
+    ModelVersion::bump();
+
     mToolFlags = 0x00000000u;
 
     mTools.clear();
@@ -282,25 +413,105 @@ cstringset& ProjectSettings::c_libraries() const
 
 void ProjectSettings::addSource(const char* source)
 {
-    if (ends_with(source, ".cmd", false))
+    mHashValid = false;
+    ModelVersion::bump();
+
+    //// Another spelling of a known file keeps its id and stored name ---------
+
+    Path path(source);
+
+    InternedString file(path.canonical());
+
+    auto inserted = mFileIds.insert(std::make_pair(file, (unsigned int)mFilePaths.size()));
+
+    if (inserted.second)
     {
-        mCommands.insert(std::string(source));
+        mFilePaths.push_back(std::move(path));
     }
-    else if (ends_with(source, ".lib", false))
+
+    const std::string& name = mFilePaths[inserted.first->second].str();
+
+    if (ends_with(name, ".cmd", false))
     {
-        mLibraries.insert(std::string(source));
+        mCommands.insert(name);
+    }
+    else if (ends_with(name, ".lib", false))
+    {
+        mLibraries.insert(name);
     }
     else
     {
-        mSources.insert(std::string(source));
+        mSources.insert(name);
     }
 }
 
 void ProjectSettings::removeSource(const char* source)
 {
-    mCommands.erase(std::string(source));
-    mLibraries.erase(std::string(source));
-    mSources.erase(std::string(source));
+    mHashValid = false;
+    ModelVersion::bump();
+
+    unsigned int fileId = this->fileId(Path(source));
+
+    std::string name = (fileId != INVALID_FILE_ID) ? fileName(fileId) : std::string(source);
+
+    mCommands.erase(name);
+    mLibraries.erase(name);
+    mSources.erase(name);
+}
+
+//// File ids ------------------------------------------------------------------
+
+unsigned int ProjectSettings::fileId(const std::string& file) const
+{
+    //// Names as stored are mostly canonical already --------------------------
+
+    const std::string* interned = StringPool::instance().find(file);
+
+    if (interned != nullptr)
+    {
+        auto it = mFileIds.find(InternedString(interned));
+
+        if (it != mFileIds.end())
+        {
+            return it->second;
+        }
+    }
+
+    return fileId(Path(file));
+}
+
+unsigned int ProjectSettings::fileId(const Path& file) const
+{
+    const std::string* interned = StringPool::instance().find(file.canonical());
+
+    if (interned == nullptr)
+    {
+        return INVALID_FILE_ID;
+    }
+
+    auto it = mFileIds.find(InternedString(interned));
+
+    if (it == mFileIds.end())
+    {
+        return INVALID_FILE_ID;
+    }
+
+    return it->second;
+}
+
+const std::string& ProjectSettings::fileName(unsigned int fileId) const
+{
+    return mFilePaths.at(fileId).str();
+}
+
+const Path& ProjectSettings::filePath(unsigned int fileId) const
+{
+    return mFilePaths.at(fileId);
+}
+
+unsigned int ProjectSettings::fileCount() const
+{
+    return (unsigned int)mFilePaths.size();
 }
 
 //// Configurations ============================================================
@@ -319,33 +530,50 @@ stringset ProjectSettings::configs() const
 
 ConfigSettings ProjectSettings::configSettings(const std::string& config) const
 {
-    if (mConfigs.find(config) != mConfigs.end())
+    return c_configSettings(config);
+}
+
+const ConfigSettings& ProjectSettings::c_configSettings(const std::string& config) const
+{
+    static const ConfigSettings defaultSettings;
+
+    configmap::const_iterator it = mConfigs.find(config);
+
+    if (it != mConfigs.end())
     {
-        return mConfigs.at(config);
+        return it->second;
     }
     else
     {
-        return ConfigSettings();
+        return defaultSettings;
     }
 }
 
 ConfigSettings& ProjectSettings::config(const std::string& config)
 {
+    ModelVersion::bump();
+
     return mConfigs[config];
 }
 
 void ProjectSettings::addConfig(const std::string& config)
 {
+    ModelVersion::bump();
+
     mConfigs.insert(std::make_pair(std::string(config), ConfigSettings()));
 }
 
 void ProjectSettings::removeConfig(const std::string& config)
 {
+    ModelVersion::bump();
+
     mConfigs.erase(config);
 }
 
 void ProjectSettings::copyConfig(const std::string& config, const std::string& newName)
 {
+    ModelVersion::bump();
+
     ConfigSettings settings = mConfigs[config];
 
     mConfigs.insert(std::make_pair(std::string(newName), std::move(settings)));
@@ -353,9 +581,107 @@ void ProjectSettings::copyConfig(const std::string& config, const std::string& n
 
 void ProjectSettings::renameConfig(const std::string& config, const std::string& newName)
 {
-    ConfigSettings settings = mConfigs[config];
+    ModelVersion::bump();
 
-    mConfigs.insert(std::make_pair(newName, std::move(settings)));
+    ConfigSettings settings = std::move(mConfigs[config]);
 
     mConfigs.erase(config);
+
+    mConfigs.insert(std::make_pair(newName, std::move(settings)));
+}
+
+void ProjectSettings::freeze()
+{
+    mConfigs.freeze();
+    mFileIds.freeze();
+
+    for (auto& config : mConfigs)
+    {
+        config.second.freeze();
+    }
+
+    shareBlocks();
+}
+
+void ProjectSettings::shareBlocks()
+{
+    //// Identical per-file options are stored once across all configurations
+
+    std::unordered_map<uint64_t, std::vector<CowPtr<FileOptions> > > blocks;
+
+    for (auto& config : mConfigs)
+    {
+        config.second.shareFileOptions(blocks);
+    }
+
+    //// Option lists equal to another configuration's share its block --------
+
+    for (configmap::iterator it = mConfigs.begin(); it != mConfigs.end(); ++it)
+    {
+        for (configmap::const_iterator previous = mConfigs.begin(); previous != it; ++previous)
+        {
+            it->second.shareBlocks(previous->second);
+        }
+    }
+}
+
+//// Structural hash ===========================================================
+
+static uint64_t hashSet(uint64_t seed, const stringset& set)
+{
+    seed = hash_combine(seed, set.size());
+
+    for (const std::string& item : set)
+    {
+        seed = hash_combine(seed, hash_string(item));
+    }
+
+    return seed;
+}
+
+uint64_t ProjectSettings::hash() const
+{
+    if (not mHashValid)
+    {
+        uint64_t result = 0;
+
+        result = hash_combine(result, (uint64_t)mType);
+        result = hash_combine(result, hash_string(mCpuFamily));
+        result = hash_combine(result, hash_string(mProjectDir));
+        result = hash_combine(result, mToolFlags);
+        result = hash_combine(result, (uint64_t)mEncoding);
+
+        result = hashSet(result, mTools);
+        result = hashSet(result, mSources);
+        result = hashSet(result, mCommands);
+        result = hashSet(result, mLibraries);
+
+        result = hash_combine(result, mFilePaths.size());
+
+        for (const Path& file : mFilePaths)
+        {
+            result = hash_combine(result, hash_string(file.str()));
+        }
+
+        mHash      = result;
+        mHashValid = true;
+    }
+
+    //// Configurations may change through config(), the version tells -------
+
+    if (mConfigsVersion != ModelVersion::current())
+    {
+        uint64_t result = hash_combine(0, mConfigs.size());
+
+        for (const auto& config : mConfigs)
+        {
+            result = hash_combine(result, hash_string(config.first));
+            result = hash_combine(result, config.second.hash());
+        }
+
+        mConfigsHash    = result;
+        mConfigsVersion = ModelVersion::current();
+    }
+
+    return hash_combine(mHash, mConfigsHash);
 }
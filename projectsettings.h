@@ -6,8 +6,11 @@
 #include <list>
 
 #include "configsettings.h"
+#include "encoding.h"
+#include "flatmap.h"
+#include "path.h"
 
-typedef std::map<std::string, ConfigSettings> configmap;
+typedef FlatMap<std::string, ConfigSettings> configmap;
 
 class ProjectSettings
 {
@@ -34,12 +37,16 @@ public:
         TOOL_ARCHIVER = 0x00000004u,
     };
 
+    static const unsigned int INVALID_FILE_ID = 0xFFFFFFFFu;
+
 public:
 
     ProjectSettings();
     ProjectSettings(const ProjectSettings& other);
+    ProjectSettings(ProjectSettings&& other) noexcept;
 
     ProjectSettings& operator=(const ProjectSettings& other);
+    ProjectSettings& operator=(ProjectSettings&& other) noexcept;
     bool operator==(const ProjectSettings& other) const;
     bool operator!=(const ProjectSettings& other) const;
 
@@ -64,6 +71,13 @@ public:
     std::string projectDir() const;
     void        setProjectDir(const char* projectDir);
 
+    //// Source encoding -------------------------------------------------------
+
+    // Encoding of the project file read, text in the model is always UTF-8
+
+    TextEncoding encoding() const;
+    void         setEncoding(TextEncoding encoding);
+
     //// Available tools -------------------------------------------------------
 
     uint32_t    toolFlags() const;
@@ -91,10 +105,19 @@ public:
     void        addSource(const char* source);
     void        removeSource(const char* source);
 
+    //// File ids --------------------------------------------------------------
+
+    unsigned int       fileId(const std::string& file) const;
+    unsigned int       fileId(const Path& file) const;
+    const std::string& fileName(unsigned int fileId) const;
+    const Path&        filePath(unsigned int fileId) const;
+    unsigned int       fileCount() const;
+
     //// Configurations ========================================================
 
     stringset       configs() const;
     ConfigSettings  configSettings(const std::string& config) const;
+    const ConfigSettings& c_configSettings(const std::string& config) const;
     ConfigSettings& config(const std::string& config);
 
     void addConfig(const std::string& config);
@@ -103,6 +126,16 @@ public:
     void copyConfig(const std::string& config, const std::string& newName);
     void renameConfig(const std::string& config, const std::string& newName);
 
+    void freeze();
+    void shareBlocks();
+
+    //// Structural hash =======================================================
+
+    // Stable across runs; the part over configurations is cached against the
+    // model version, so changes through config() references are seen
+
+    uint64_t hash() const;
+
     //// =======================================================================
 
 private:
@@ -112,12 +145,25 @@ private:
 
     uint32_t    mToolFlags;
 
+    TextEncoding mEncoding;
+
     configmap   mConfigs;
 
     stringset   mTools;
     stringset   mSources;
     stringset   mCommands;
     stringset   mLibraries;
+
+    // Files are identified by their canonical paths
+
+    std::vector<Path>                     mFilePaths;
+    FlatMap<InternedString, unsigned int> mFileIds;
+
+    mutable uint64_t mHash;
+    mutable bool     mHashValid;
+
+    mutable uint64_t mConfigsHash;
+    mutable uint64_t mConfigsVersion;   // Model version the hash was taken at
 };
 
 #endif // PROJECTSETTINGS_H
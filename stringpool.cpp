@@ -0,0 +1,157 @@
+#include "stringpool.h"
+
+//// String pool ===============================================================
+
+StringPool::StringPool() :
+    mRequests(0),
+    mRequestedBytes(0),
+    mStoredBytes(0)
+{
+
+}
+
+StringPool& StringPool::instance()
+{
+    static StringPool pool;
+
+    return pool;
+}
+
+const std::string* StringPool::intern(const std::string& str)
+{
+    ++mRequests;
+    mRequestedBytes += str.size();
+
+    if (str.empty())
+    {
+        return &mEmpty;
+    }
+
+    std::pair<std::unordered_set<std::string>::iterator, bool> result = mStrings.insert(str);
+
+    if (result.second)
+    {
+        mStoredBytes += str.size();
+    }
+
+    // Set elements are never moved, so the pointer outlives rehashing
+
+    return &(*result.first);
+}
+
+const std::string* StringPool::find(const std::string& str) const
+{
+    if (str.empty())
+    {
+        return &mEmpty;
+    }
+
+    std::unordered_set<std::string>::const_iterator it = mStrings.find(str);
+
+    if (it == mStrings.end())
+    {
+        return nullptr;
+    }
+
+    return &(*it);
+}
+
+size_t StringPool::size() const
+{
+    return mStrings.size();
+}
+
+void StringPool::clear()
+{
+    mStrings.clear();
+
+    mRequests       = 0;
+    mRequestedBytes = 0;
+    mStoredBytes    = 0;
+}
+
+//// Statistics ================================================================
+
+size_t StringPool::requests() const
+{
+    return mRequests;
+}
+
+size_t StringPool::requestedBytes() const
+{
+    return mRequestedBytes;
+}
+
+size_t StringPool::storedBytes() const
+{
+    return mStoredBytes;
+}
+
+size_t StringPool::savedBytes() const
+{
+    return mRequestedBytes - mStoredBytes;
+}
+
+//// Interned string ===========================================================
+
+InternedString::InternedString()
+{
+    static const std::string* empty = StringPool::instance().intern(std::string());
+
+    mString = empty;
+}
+
+InternedString::InternedString(const std::string& str) :
+    mString(StringPool::instance().intern(str))
+{
+
+}
+
+InternedString::InternedString(const char* str) :
+    mString(StringPool::instance().intern(std::string(str)))
+{
+
+}
+
+InternedString::InternedString(const std::string* interned) :
+    mString(interned)
+{
+
+}
+
+bool InternedString::operator==(const InternedString& other) const
+{
+    return mString == other.mString;
+}
+
+bool InternedString::operator!=(const InternedString& other) const
+{
+    return mString != other.mString;
+}
+
+bool InternedString::operator<(const InternedString& other) const
+{
+    // Ordered by contents, so sets and maps keep their string order
+
+    return (mString != other.mString) && (*mString < *other.mString);
+}
+
+InternedString::operator const std::string&() const
+{
+    return *mString;
+}
+
+const std::string& InternedString::str() const
+{
+    return *mString;
+}
+
+const char* InternedString::c_str() const
+{
+    return mString->c_str();
+}
+
+bool InternedString::empty() const
+{
+    return mString->empty();
+}
@@ -0,0 +1,72 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <string>
+#include <unordered_set>
+
+class StringPool
+{
+public:
+    StringPool();
+
+    static StringPool& instance();
+
+    const std::string* intern(const std::string& str);
+    const std::string* find(const std::string& str) const;
+
+    size_t size() const;
+
+    // Drops all strings and statistics. Only for when no InternedString other
+    // than empty ones is left, e.g. between two projects
+
+    void clear();
+
+    //// Statistics ============================================================
+
+    size_t requests() const;
+    size_t requestedBytes() const;
+    size_t storedBytes() const;
+    size_t savedBytes() const;
+
+private:
+
+    std::unordered_set<std::string> mStrings;
+
+    // Kept out of the set, so default strings outlive clear()
+
+    const std::string mEmpty;
+
+    size_t mRequests;
+    size_t mRequestedBytes;
+    size_t mStoredBytes;
+
+    StringPool(const StringPool& other);
+    StringPool& operator=(const StringPool& other);
+};
+
+class InternedString
+{
+public:
+    InternedString();
+    InternedString(const std::string& str);
+    InternedString(const char* str);
+
+    explicit InternedString(const std::string* interned);
+
+    bool operator==(const InternedString& other) const;
+    bool operator!=(const InternedString& other) const;
+    bool operator<(const InternedString& other) const;
+
+    operator const std::string&() const;
+
+    const std::string& str() const;
+    const char*        c_str() const;
+
+    bool empty() const;
+
+private:
+
+    const std::string* mString;
+};
+
+#endif // STRINGPOOL_H
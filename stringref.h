@@ -0,0 +1,246 @@
+#ifndef STRINGREF_H
+#define STRINGREF_H
+
+#include <string>
+#include <string.h>
+#include <cstddef>
+#include <iterator>
+
+// Read-only view of characters owned by someone else, the C++11 stand-in for
+// std::string_view. Building one from a literal or a std::string never
+// allocates; the viewed text must outlive the view.
+
+class StringRef
+{
+public:
+    static const size_t npos = (size_t)-1;
+
+public:
+    StringRef() : mData(""), mSize(0)
+    {
+
+    }
+
+    StringRef(const char* str) : mData(str), mSize(strlen(str))
+    {
+
+    }
+
+    StringRef(const char* data, size_t size) : mData(data), mSize(size)
+    {
+
+    }
+
+    StringRef(const char* begin, const char* end) : mData(begin), mSize((size_t)(end - begin))
+    {
+
+    }
+
+    StringRef(const std::string& str) : mData(str.data()), mSize(str.size())
+    {
+
+    }
+
+    const char* data() const   { return mData; }
+    size_t      size() const   { return mSize; }
+    size_t      length() const { return mSize; }
+    bool        empty() const  { return mSize == 0; }
+
+    const char* begin() const  { return mData; }
+    const char* end() const    { return mData + mSize; }
+
+    char operator[](size_t pos) const { return mData[pos]; }
+
+    char front() const { return mData[0]; }
+    char back() const  { return mData[mSize - 1]; }
+
+    StringRef substr(size_t pos, size_t count = npos) const
+    {
+        if (pos > mSize)
+        {
+            pos = mSize;
+        }
+
+        if (count > mSize - pos)
+        {
+            count = mSize - pos;
+        }
+
+        return StringRef(mData + pos, count);
+    }
+
+    size_t find(char c, size_t pos = 0) const
+    {
+        if (pos >= mSize)
+        {
+            return npos;
+        }
+
+        const void* found = memchr(mData + pos, c, mSize - pos);
+
+        return (found == nullptr) ? npos : (size_t)(static_cast<const char*>(found) - mData);
+    }
+
+    size_t find(StringRef str, size_t pos = 0) const
+    {
+        if (str.mSize == 0)
+        {
+            return (pos <= mSize) ? pos : npos;
+        }
+
+        while (pos + str.mSize <= mSize)
+        {
+            pos = find(str.mData[0], pos);
+
+            if (pos == npos || pos + str.mSize > mSize)
+            {
+                return npos;
+            }
+
+            if (memcmp(mData + pos, str.mData, str.mSize) == 0)
+            {
+                return pos;
+            }
+
+            ++pos;
+        }
+
+        return npos;
+    }
+
+    size_t rfind(char c) const
+    {
+        for (size_t pos = mSize; pos > 0; --pos)
+        {
+            if (mData[pos - 1] == c)
+            {
+                return pos - 1;
+            }
+        }
+
+        return npos;
+    }
+
+    bool operator==(StringRef other) const
+    {
+        return mSize == other.mSize && memcmp(mData, other.mData, mSize) == 0;
+    }
+
+    bool operator!=(StringRef other) const
+    {
+        return !(*this == other);
+    }
+
+    std::string str() const
+    {
+        return std::string(mData, mSize);
+    }
+
+    void appendTo(std::string& out) const
+    {
+        out.append(mData, mSize);
+    }
+
+private:
+    const char* mData;
+    size_t      mSize;
+};
+
+// Pieces of a string between separators, produced while iterating, so
+//   for (StringRef part : StringSplit(path, '/'))
+// allocates nothing. Matches split(): empty input gives no pieces,
+// separators next to each other give empty ones
+
+class StringSplit
+{
+public:
+    class iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef StringRef                 value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef const StringRef*          pointer;
+        typedef StringRef                 reference;
+
+    public:
+        iterator() : mSep(0), mHasRest(false), mAtEnd(true)
+        {
+
+        }
+
+        iterator(StringRef str, char sep) : mRest(str), mSep(sep), mHasRest(not str.empty()), mAtEnd(false)
+        {
+            advance();
+        }
+
+        StringRef operator*() const         { return mPart; }
+        const StringRef* operator->() const { return &mPart; }
+
+        iterator& operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            if (mAtEnd || other.mAtEnd)
+            {
+                return mAtEnd == other.mAtEnd;
+            }
+
+            return mPart.data() == other.mPart.data() && mPart.size() == other.mPart.size();
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+
+        void advance()
+        {
+            if (not mHasRest)
+            {
+                mAtEnd = true;
+                return;
+            }
+
+            size_t pos = mRest.find(mSep);
+
+            if (pos == StringRef::npos)
+            {
+                mPart    = mRest;
+                mHasRest = false;
+            }
+            else
+            {
+                mPart = mRest.substr(0, pos);
+                mRest = mRest.substr(pos + 1);
+            }
+        }
+
+        StringRef mRest;
+        StringRef mPart;
+        char      mSep;
+        bool      mHasRest;
+        bool      mAtEnd;
+    };
+
+public:
+    StringSplit(StringRef str, char sep) : mStr(str), mSep(sep)
+    {
+
+    }
+
+    iterator begin() const { return iterator(mStr, mSep); }
+    iterator end() const   { return iterator(); }
+
+private:
+    StringRef mStr;
+    char      mSep;
+};
+
+#endif // STRINGREF_H
@@ -0,0 +1,115 @@
+// Checks that the string view helpers allocate nothing; run by "make check".
+// Arguments are longer than the small string buffer, so a copy would show.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "stringref.h"
+#include "utils.h"
+
+//// Allocation counter ========================================================
+
+static size_t sAllocations = 0;
+
+void* operator new(size_t size)
+{
+    ++sAllocations;
+
+    void* pointer = malloc(size != 0 ? size : 1);
+
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+static int sFailures = 0;
+
+static void expect(const char* name, size_t allocations, bool result)
+{
+    if (allocations != 0 || not result)
+    {
+        printf("FAIL %s: %u allocations, result %s\n", name, (unsigned int)allocations, result ? "ok" : "wrong");
+        ++sFailures;
+    }
+    else
+    {
+        printf("ok   %s\n", name);
+    }
+}
+
+//// Checks ====================================================================
+
+int main()
+{
+    const std::string path = "C:/ti/c6000/cgtools/lib/rts6700.lib";
+
+    std::vector<std::string> list;
+    list.push_back("../inc0");
+    list.push_back("$(INC)/include");
+    list.push_back("C:/ti/c6000/cgtools/include");
+
+    std::set<std::string> set(list.begin(), list.end());
+
+    std::string expected = join(list, ' ') + " " + join(set, ' ');
+
+    std::string buffer;
+    buffer.reserve(4096);
+
+    size_t before = sAllocations;
+    bool   result = starts_with(path, "C:/ti/c6000/cgtools/") && starts_with("Release", "Rel") && not starts_with(path, "D:");
+    expect("starts_with", sAllocations - before, result);
+
+    before = sAllocations;
+    result = ends_with(path, "/cgtools/lib/rts6700.lib") && ends_with(list[0], "inc0") && not ends_with("a.c", "long.c");
+    expect("ends_with", sAllocations - before, result);
+
+    before = sAllocations;
+    size_t pieces = 0;
+    size_t bytes  = 0;
+    for (StringRef part : StringSplit(path, '/'))
+    {
+        ++pieces;
+        bytes += part.size();
+    }
+    expect("StringSplit", sAllocations - before, pieces == 6 && bytes == path.size() - 5);
+
+    before = sAllocations;
+    join_to(buffer, list, ' ');
+    buffer.push_back(' ');
+    join_to(buffer, set, ' ');
+    expect("join_to", sAllocations - before, buffer == expected);
+
+    return (sFailures == 0) ? 0 : 1;
+}
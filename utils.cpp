@@ -1,7 +1,11 @@
 ﻿#include "utils.h"
 
+#include <algorithm>
 #include <memory>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 std::string string_format(const char* format, ...)
 {
@@ -29,38 +33,43 @@ std::string string_format(const char* format, ...)
     return std::string(buf.get(), buf.get() + size - 1);
 }
 
-bool starts_with(const std::string& str, const std::string& start, bool case_sensitive)
+bool starts_with(StringRef str, StringRef start, bool case_sensitive)
 {
+    if (start.length() > str.length())
+    {
+        return false;
+    }
+
     if (case_sensitive)
     {
-        return (strncasecmp(str.c_str(), start.c_str(), start.length()) == 0);
+        return (strncasecmp(str.data(), start.data(), start.length()) == 0);
     }
     else
     {
-        return (strncmp(str.c_str(), start.c_str(), start.length()) == 0);
+        return (strncmp(str.data(), start.data(), start.length()) == 0);
     }
 }
 
-bool ends_with(const std::string& str, const std::string& end, bool case_sensitive)
+bool ends_with(StringRef str, StringRef end, bool case_sensitive)
 {
     if (end.length() > str.length())
     {
         return false;
     }
 
-    std::size_t offset = str.length() - end.length();
+    const char* tail = str.data() + (str.length() - end.length());
 
     if (case_sensitive)
     {
-        return (strcasecmp(str.substr(offset).c_str(), end.c_str()) == 0);
+        return (strncasecmp(tail, end.data(), end.length()) == 0);
     }
     else
     {
-        return (strcmp(str.substr(offset).c_str(), end.c_str()) == 0);
+        return (strncmp(tail, end.data(), end.length()) == 0);
     }
 }
 
-bool is_flag(const std::string& option, const char* flag, std::string& value)
+bool is_flag(StringRef option, const char* flag, std::string& value)
 {
     size_t flaglen = strlen(flag);
 
@@ -70,7 +79,7 @@ bool is_flag(const std::string& option, const char* flag, std::string& value)
             option[flaglen] == '"' &&
             option.back() == '"')
         {
-            value = option.substr(flaglen + 1, option.length() - 2 - flaglen);
+            value.assign(option.data() + flaglen + 1, option.length() - 2 - flaglen);
             return true;
         }
     }
@@ -78,23 +87,25 @@ bool is_flag(const std::string& option, const char* flag, std::string& value)
     return false;
 }
 
-bool split_config_line(const std::string& line, std::string& key, std::string& val)
+bool split_config_line(StringRef line, std::string& key, std::string& val)
 {
     std::size_t pos = line.find('=');
 
-    if (pos == std::string::npos)
+    if (pos == StringRef::npos)
     {
         return false;
     }
 
-    key = line.substr(0, pos);
-    val = line.substr(pos + 1);
+    StringRef value = line.substr(pos + 1);
 
-    if (in_quotes(val))
+    if (in_quotes(value))
     {
-        remove_quotes(val);
+        value = value.substr(1, value.length() - 2);
     }
 
+    key.assign(line.data(), pos);
+    val.assign(value.data(), value.length());
+
     return true;
 }
 
@@ -115,24 +126,20 @@ std::string replace(std::string str, char from, char to)
 
 std::string fixpath(std::string str)
 {
-    return replace(str, '\\', '/');
+    return replace(std::move(str), '\\', '/');
 }
 
-bool in_quotes(const std::string& str)
+bool in_quotes(StringRef str)
 {
-    if (str.length() >= 2 && starts_with(str, "\"") && ends_with(str, "\""))
-    {
-        return true;
-    }
-
-    return false;
+    return (str.length() >= 2 && str.front() == '"' && str.back() == '"');
 }
 
 bool remove_quotes(std::string& str)
 {
     if (in_quotes(str))
     {
-        str = str.substr(1, str.length() - 2);
+        str.erase(str.length() - 1);
+        str.erase(0, 1);
         return true;
     }
 
@@ -151,19 +158,7 @@ std::set<std::string> keys(const std::map<std::string, std::set<std::string> > &
     return result;
 }
 
-std::set<std::string> keys(const std::map<std::string, std::list<std::string> > &map)
-{
-    std::set<std::string> result;
-
-    for (auto it = map.begin(); it != map.end(); ++it)
-    {
-        result.insert(it->first);
-    }
-
-    return result;
-}
-
-std::set<std::string> keys(const std::map<std::string, FileOptions>& map)
+std::set<std::string> keys(const std::map<std::string, std::vector<std::string> > &map)
 {
     std::set<std::string> result;
 
@@ -175,102 +170,122 @@ std::set<std::string> keys(const std::map<std::string, FileOptions>& map)
     return result;
 }
 
-std::string join(const std::list<std::string> &list, char sep)
+template <typename List>
+static void append_joined(std::string& out, const List& list, char sep)
 {
     size_t listsize = 0;
-    std::string result;
 
     for (const std::string& str : list)
     {
         listsize += str.size() + 1;
     }
 
-    result.reserve(listsize);
+    out.reserve(out.size() + listsize);
+
+    bool first = true;
 
     for (const std::string& str : list)
     {
-        result.append(str);
-        result.append(std::string(&sep, 1));
-    }
+        if (not first)
+        {
+            out.push_back(sep);
+        }
 
-    if (not result.empty())
-    {
-        result.pop_back();
+        out.append(str);
+        first = false;
     }
+}
 
+std::string join(const std::vector<std::string> &list, char sep)
+{
+    std::string result;
+    append_joined(result, list, sep);
     return result;
 }
 
 std::string join(const std::set<std::string> &list, char sep)
 {
-    size_t listsize = 0;
     std::string result;
+    append_joined(result, list, sep);
+    return result;
+}
 
-    for (const std::string& str : list)
-    {
-        listsize += str.size() + 1;
-    }
-
-    result.reserve(listsize);
+std::string join(const internedset &list, char sep)
+{
+    std::string result;
+    append_joined(result, list, sep);
+    return result;
+}
 
-    for (const std::string& str : list)
-    {
-        result.append(str);
-        result.append(std::string(&sep, 1));
-    }
+void join_to(std::string& out, const std::vector<std::string>& list, char sep)
+{
+    append_joined(out, list, sep);
+}
 
-    if (not result.empty())
-    {
-        result.pop_back();
-    }
+void join_to(std::string& out, const std::set<std::string>& list, char sep)
+{
+    append_joined(out, list, sep);
+}
 
-    return result;
+void join_to(std::string& out, const internedset& list, char sep)
+{
+    append_joined(out, list, sep);
 }
 
-std::list<std::string> split(const std::string& str, char sep)
+std::vector<std::string> split(StringRef str, char sep)
 {
-    std::list<std::string> result;
+    std::vector<std::string> result;
 
     if (str.empty())
     {
         return result;
     }
 
-    std::size_t pos = 0;
+    result.reserve((size_t)std::count(str.begin(), str.end(), sep) + 1);
 
-    while (pos != std::string::npos)
+    for (StringRef part : StringSplit(str, sep))
     {
-        std::size_t end = str.substr(pos).find(sep);
+        result.push_back(part.str());
+    }
 
-        result.push_back(str.substr(pos, end));
+    return result;
+}
 
-        if (end == std::string::npos)
-        {
-            break;
-        }
-        else
-        {
-            pos += end + 1;
-        }
+void erase_all(std::vector<std::string>& list, const std::string& value)
+{
+    list.erase(std::remove(list.begin(), list.end(), value), list.end());
+}
+
+bool between(StringRef str, StringRef from, StringRef to, std::string& res)
+{
+    StringRef found;
+
+    if (between(str, from, to, found))
+    {
+        res.assign(found.data(), found.length());
+
+        return true;
     }
 
-    return result;
+    return false;
 }
 
-bool between(const std::string& str, const char* from, const char* to, std::string& res)
+bool between(StringRef str, StringRef from, StringRef to, StringRef& res)
 {
     std::size_t start_pos = str.find(from);
 
-    if (start_pos != std::string::npos)
+    if (start_pos != StringRef::npos)
     {
-        std::size_t len = str.substr(start_pos + strlen(from)).find(to);
+        start_pos += from.length();
+
+        std::size_t end_pos = str.find(to, start_pos);
 
-        if (len == std::string::npos)
+        if (end_pos == StringRef::npos)
         {
             return false;
         }
 
-        res = str.substr(start_pos + strlen(from), len);
+        res = str.substr(start_pos, end_pos - start_pos);
 
         return true;
     }
@@ -300,6 +315,35 @@ std::string to_option(const std::string& flag, const std::string& value, bool qu
     return option;
 }
 
+std::string to_json_string(const std::string& str)
+{
+    std::string result;
+    result.reserve(str.length() + 2);
+
+    result.push_back('"');
+
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result.push_back('\\');
+            result.push_back(c);
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            result.append(string_format("\\u%04x", (unsigned int)(unsigned char)c));
+        }
+        else
+        {
+            result.push_back(c);
+        }
+    }
+
+    result.push_back('"');
+
+    return result;
+}
+
 std::string to_upper(std::string s)
 {
     size_t len = s.size();
@@ -324,9 +368,10 @@ std::string to_lower(std::string s)
     return s;
 }
 
-std::list<std::string> to_lower(const std::set<std::string>& s)
+std::vector<std::string> to_lower(const std::set<std::string>& s)
 {
-    std::list<std::string> result;
+    std::vector<std::string> result;
+    result.reserve(s.size());
 
     for (const std::string& str : s)
     {
@@ -336,72 +381,156 @@ std::list<std::string> to_lower(const std::set<std::string>& s)
     return result;
 }
 
-std::string cp1251_to_unicode(std::string cp1251)
-{
-    static const short utf[256] =
-    {
-        0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007,
-        0x0008, 0x0009, 0x000a, 0x000b, 0x000c, 0x000d, 0x000e, 0x000f,
-        0x0010, 0x0011, 0x0012, 0x0013, 0x0014, 0x0015, 0x0016, 0x0017,
-        0x0018, 0x0019, 0x001a, 0x001b, 0x001c, 0x001d, 0x001e, 0x001f,
-        0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027,
-        0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
-        0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
-        0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
-        0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
-        0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
-        0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
-        0x0058, 0x0059, 0x005a, 0x005b, 0x005c, 0x005d, 0x005e, 0x005f,
-        0x0060, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067,
-        0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
-        0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077,
-        0x0078, 0x0079, 0x007a, 0x007b, 0x007c, 0x007d, 0x007e, 0x007f,
-        0x0402, 0x0403, 0x201a, 0x0453, 0x201e, 0x2026, 0x2020, 0x2021,
-        0x20ac, 0x2030, 0x0409, 0x2039, 0x040a, 0x040c, 0x040b, 0x040f,
-        0x0452, 0x2018, 0x2019, 0x201c, 0x201d, 0x2022, 0x2013, 0x2014,
-        0x0000, 0x2122, 0x0459, 0x203a, 0x045a, 0x045c, 0x045b, 0x045f,
-        0x00a0, 0x040e, 0x045e, 0x0408, 0x00a4, 0x0490, 0x00a6, 0x00a7,
-        0x0401, 0x00a9, 0x0404, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x0407,
-        0x00b0, 0x00b1, 0x0406, 0x0456, 0x0491, 0x00b5, 0x00b6, 0x00b7,
-        0x0451, 0x2116, 0x0454, 0x00bb, 0x0458, 0x0405, 0x0455, 0x0457,
-        0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
-        0x0418, 0x0419, 0x041a, 0x041b, 0x041c, 0x041d, 0x041e, 0x041f,
-        0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
-        0x0428, 0x0429, 0x042a, 0x042b, 0x042c, 0x042d, 0x042e, 0x042f,
-        0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
-        0x0438, 0x0439, 0x043a, 0x043b, 0x043c, 0x043d, 0x043e, 0x043f,
-        0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
-        0x0448, 0x0449, 0x044a, 0x044b, 0x044c, 0x044d, 0x044e, 0x044f
-    };
+std::string basename(StringRef path)
+{
+    std::size_t pos = path.rfind('/');
 
-    std::string result;
+    if (pos == StringRef::npos)
+    {
+        return path.str();
+    }
+
+    return path.substr(pos + 1).str();
+}
 
-    for (char c1251 : cp1251)
+std::string dirname(const std::string& path)
+{
+    std::size_t pos = path.find_last_of("/\\");
+
+    if (pos == std::string::npos)
     {
-        short c = utf[(unsigned char)c1251];
-        if (c < 0x80)
-        {
-            result.push_back((char)c);
-        }
-        else if (c < 0x800)
-        {
-            result.push_back((char)(c >> 6 | 0xc0));
-            result.push_back((char)((c & 0x3f) | 0x80));
-        }
+        return ".";
     }
 
-    return result;
+    if (pos == 0)
+    {
+        return "/";
+    }
+
+    return path.substr(0, pos);
 }
 
+static bool resolve_path(const std::string& path, std::string& resolved)
+{
+#ifdef _WIN32
+    char* result = _fullpath(nullptr, path.c_str(), 0);
+#else
+    char* result = realpath(path.c_str(), nullptr);
+#endif
+
+    if (result == nullptr)
+    {
+        return false;
+    }
+
+    resolved = result;
+    free(result);
 
-std::string basename(const std::string& path)
+    return true;
+}
+
+std::string absolute_path(const std::string& path)
 {
-    std::list<std::string> pathlist = split(path, '/');
+    std::string resolved;
 
-    if (pathlist.size() > 1)
+    if (resolve_path(path, resolved))
     {
-        return pathlist.back();
+        return resolved;
+    }
+
+    if (resolve_path(dirname(path), resolved))
+    {
+        return resolved + "/" + basename(path);
     }
 
     return path;
 }
+
+unsigned long file_size(const std::string& path)
+{
+    struct stat fileStat;
+
+    if (stat(path.c_str(), &fileStat) != 0)
+    {
+        return 0;
+    }
+
+    return (unsigned long)fileStat.st_size;
+}
+
+bool read_file(const std::string& path, std::string& content)
+{
+    content.clear();
+
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char buffer[16384];
+    size_t read = 0;
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        content.append(buffer, read);
+    }
+
+    bool res = (ferror(file) == 0);
+
+    fclose(file);
+
+    return res;
+}
+
+std::string object_name(StringRef source)
+{
+    StringRef name = source.substr(source.rfind('/') + 1);
+
+    std::size_t pos = name.rfind('.');
+
+    if (pos == StringRef::npos)
+    {
+        return name.str();
+    }
+
+    std::string result;
+    result.reserve(pos + 4);
+
+    name.substr(0, pos).appendTo(result);
+    result.append(".obj");
+
+    return result;
+}
+
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed)
+{
+    // 64-bit FNV-1a, stable across runs and platforms
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    uint64_t result = seed;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        result ^= bytes[i];
+        result *= 0x100000001b3ull;
+    }
+
+    return result;
+}
+
+uint64_t hash_string(StringRef str, uint64_t seed)
+{
+    // The length keeps "ab","c" apart from "a","bc"
+
+    return hash_combine(hash_bytes(str.data(), str.size(), seed), str.size());
+}
+
+uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 12) + (seed >> 4);
+
+    return seed;
+}
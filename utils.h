@@ -2,48 +2,71 @@
 #define UTILS_H
 
 #include <string>
-#include <list>
+#include <vector>
 #include <set>
 #include <map>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include "fileoptions.h"
+#include "stringref.h"
 
 std::string string_format(const char* format, ...);
 
-bool starts_with(const std::string& str, const std::string& start, bool case_sensitive = true);
-bool ends_with(const std::string& str, const std::string& end, bool case_sensitive = true);
+bool starts_with(StringRef str, StringRef start, bool case_sensitive = true);
+bool ends_with(StringRef str, StringRef end, bool case_sensitive = true);
 
-bool is_flag(const std::string& option, const char* flag, std::string& value);
+bool is_flag(StringRef option, const char* flag, std::string& value);
 
-bool split_config_line(const std::string& line, std::string& key, std::string& val);
+bool split_config_line(StringRef line, std::string& key, std::string& val);
 
 std::string replace(std::string str, char from, char to);
 std::string fixpath(std::string str);
 
-bool in_quotes(const std::string& str);
+bool in_quotes(StringRef str);
 bool remove_quotes(std::string& str);
 
 std::set<std::string> keys(const std::map< std::string, std::set<std::string> >& map);
-std::set<std::string> keys(const std::map< std::string, std::list<std::string> >& map);
-std::set<std::string> keys(const std::map< std::string,  FileOptions>& map);
+std::set<std::string> keys(const std::map< std::string, std::vector<std::string> >& map);
 
-std::string join(const std::list<std::string>& list, char sep);
+std::string join(const std::vector<std::string>& list, char sep);
 std::string join(const std::set<std::string>& list, char sep);
+std::string join(const internedset& list, char sep);
 
-std::list<std::string> split(const std::string& str, char sep);
+void join_to(std::string& out, const std::vector<std::string>& list, char sep);
+void join_to(std::string& out, const std::set<std::string>& list, char sep);
+void join_to(std::string& out, const internedset& list, char sep);
 
-bool between(const std::string& str, const char* from, const char* to, std::string& res);
+std::vector<std::string> split(StringRef str, char sep);
+
+void erase_all(std::vector<std::string>& list, const std::string& value);
+
+bool between(StringRef str, StringRef from, StringRef to, std::string& res);
+bool between(StringRef str, StringRef from, StringRef to, StringRef& res);
 
 std::string to_option(const std::string& flag, const std::string& value, bool quote = true);
+std::string to_json_string(const std::string& str);
 
 std::string to_upper(std::string s);
 std::string to_lower(std::string s);
 
-std::list<std::string> to_lower(const std::set<std::string>& s);
+std::vector<std::string> to_lower(const std::set<std::string>& s);
+
+std::string basename(StringRef path);
+std::string dirname(const std::string& path);
+
+// Resolved absolute path, a file yet to be created resolves through its
+// directory; the path is returned as given if neither exists
+
+std::string absolute_path(const std::string& path);
+
+unsigned long file_size(const std::string& path);
+bool          read_file(const std::string& path, std::string& content);
 
-std::string cp1251_to_unicode(std::string cp1251);
+std::string object_name(StringRef source);
 
-std::string basename(const std::string& path);
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+uint64_t hash_string(StringRef str, uint64_t seed = 0xcbf29ce484222325ull);
+uint64_t hash_combine(uint64_t seed, uint64_t value);
 
 #endif // UTILS_H
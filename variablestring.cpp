@@ -0,0 +1,190 @@
+#include "variablestring.h"
+
+#include <ctype.h>
+
+static inline bool is_name_char(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+//// Variable string ===========================================================
+
+VariableString::VariableString()
+{
+
+}
+
+VariableString::VariableString(StringRef text) : mText(text.data(), text.length())
+{
+    size_t begin = 0;
+    bool   inVariable = false;
+
+    for (size_t i = 0; i < mText.size(); ++i)
+    {
+        char& c = mText[i];
+
+        if (c == '\\')
+        {
+            c = '/';
+        }
+        else if (c == '%')
+        {
+            if (i > begin || inVariable)
+            {
+                Segment segment = { begin, i - begin, inVariable, true };
+                mSegments.push_back(segment);
+            }
+
+            begin = i + 1;
+            inVariable = not inVariable;
+        }
+    }
+
+    if (mText.size() > begin || inVariable)
+    {
+        Segment segment = { begin, mText.size() - begin, inVariable, not inVariable };
+        mSegments.push_back(segment);
+    }
+}
+
+bool VariableString::empty() const
+{
+    return mText.empty();
+}
+
+bool VariableString::hasVariables() const
+{
+    for (const Segment& segment : mSegments)
+    {
+        if (segment.variable)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void VariableString::render(std::string& out, Dialect dialect) const
+{
+    out.reserve(out.size() + mText.size() + 2 * mSegments.size());
+
+    for (size_t i = 0; i < mSegments.size(); ++i)
+    {
+        const Segment& segment = mSegments[i];
+
+        const char* text = mText.data() + segment.begin;
+
+        if (not segment.variable)
+        {
+            out.append(text, segment.length);
+            continue;
+        }
+
+        //// Unmatched '%' -----------------------------------------------------
+
+        if (not segment.closed)
+        {
+            out.append((dialect == Dialect::MAKE) ? "$(" : "%");
+            out.append(text, segment.length);
+            continue;
+        }
+
+        //// "%%" is an escaped '%' outside make ------------------------------
+
+        if (segment.length == 0 && dialect != Dialect::MAKE)
+        {
+            out.push_back('%');
+            continue;
+        }
+
+        //// Reference ---------------------------------------------------------
+
+        switch (dialect)
+        {
+        case Dialect::MAKE:
+            out.append("$(");
+            out.append(text, segment.length);
+            out.push_back(')');
+            break;
+
+        case Dialect::NINJA:
+            out.append("${");
+            out.append(text, segment.length);
+            out.push_back('}');
+            break;
+
+        case Dialect::SHELL:
+        {
+            bool braces = false;
+
+            if (i + 1 < mSegments.size())
+            {
+                const Segment& next = mSegments[i + 1];
+                braces = next.variable || (next.length > 0 && is_name_char(mText[next.begin]));
+            }
+
+            out.append(braces ? "${" : "$");
+            out.append(text, segment.length);
+
+            if (braces)
+            {
+                out.push_back('}');
+            }
+
+            break;
+        }
+        }
+    }
+}
+
+std::string VariableString::render(Dialect dialect) const
+{
+    std::string result;
+
+    render(result, dialect);
+
+    return result;
+}
+
+void VariableString::variables(std::set<std::string>& variables) const
+{
+    for (const Segment& segment : mSegments)
+    {
+        if (segment.variable && segment.closed)
+        {
+            variables.insert(std::string(mText.data() + segment.begin, segment.length));
+        }
+    }
+}
+
+//// One-shot helpers ==========================================================
+
+std::string VariableString::render(StringRef text, Dialect dialect)
+{
+    return VariableString(text).render(dialect);
+}
+
+void VariableString::variables(StringRef text, std::set<std::string>& variables)
+{
+    // Only references are needed, so no segments are kept
+
+    size_t begin = 0;
+    bool   inVariable = false;
+
+    for (size_t i = 0; i < text.length(); ++i)
+    {
+        if (text[i] != '%')
+        {
+            continue;
+        }
+
+        if (inVariable)
+        {
+            variables.insert(std::string(text.data() + begin, i - begin));
+        }
+
+        begin = i + 1;
+        inVariable = not inVariable;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef VARIABLESTRING_H
+#define VARIABLESTRING_H
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "stringref.h"
+
+// Text with %VAR% references, split once into literal and variable segments
+// and rendered for a build tool in a single pass. Backslashes become '/' as
+// the text is split. An unmatched '%' opens a reference that runs to the end
+// of the text: make gets "$(" with no closing, the other dialects a literal
+// '%', as they have no way to spell it. "%%" stays "$()" for make, as it
+// always has, and is a literal '%' elsewhere.
+
+class VariableString
+{
+public:
+
+    enum class Dialect
+    {
+        MAKE,   // $(VAR)
+        NINJA,  // ${VAR}
+        SHELL,  // $VAR, or ${VAR} when a name character follows
+    };
+
+public:
+    VariableString();
+    explicit VariableString(StringRef text);
+
+    bool empty() const;
+    bool hasVariables() const;
+
+    void        render(std::string& out, Dialect dialect = Dialect::MAKE) const;
+    std::string render(Dialect dialect = Dialect::MAKE) const;
+
+    void        variables(std::set<std::string>& variables) const;
+
+    //// One-shot helpers ======================================================
+
+    static std::string render(StringRef text, Dialect dialect = Dialect::MAKE);
+    static void        variables(StringRef text, std::set<std::string>& variables);
+
+private:
+
+    struct Segment
+    {
+        size_t begin;
+        size_t length;
+        bool   variable;
+        bool   closed;
+    };
+
+    std::string          mText;
+    std::vector<Segment> mSegments;
+};
+
+#endif // VARIABLESTRING_H